@@ -10,6 +10,7 @@
  * Attention: This software (modified or not) and binary are used for 
  * microcontroller manufactured by Nanjing Qinheng Microelectronics.
  *******************************************************************************/
+#include <stddef.h>
 #include <debug.h>
 
 static uint8_t  p_us = 0;
@@ -27,7 +28,27 @@ static uint16_t p_ms = 0;
  */
 void Delay_Init(void)
 {
-    p_us = SystemCoreClock / 8000000;
+    Delay_Update();
+
+    // Free-running 32-bit up counter, HCLK, so counts are core cycles (prof.h).
+    // Delays and Millis() measure elapsed counts, so the counter is never
+    // reset or stopped.
+    SysTick->CTLR = 0;
+    SysTick->CNT = 0;
+    SysTick->CTLR = (1 << 2) | (1 << 0); // STCLK: HCLK, STE
+}
+
+/*********************************************************************
+ * @fn      Delay_Update
+ *
+ * @brief   Recompute delay constants from SystemCoreClock, after a
+ *          clock change (User/clock.c).  The counter keeps running.
+ *
+ * @return  none
+ */
+void Delay_Update(void)
+{
+    p_us = SystemCoreClock / 1000000;
     p_ms = (uint16_t)p_us * 1000;
 }
 
@@ -42,17 +63,10 @@ void Delay_Init(void)
  */
 void Delay_Us(uint32_t n)
 {
-    uint32_t i;
-
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n * p_us;
-
-    SysTick->CMP = i;
-    SysTick->CNT = 0;
-    SysTick->CTLR |=(1 << 0);
+    uint32_t start = SysTick->CNT;
+    uint32_t i = (uint32_t)n * p_us;
 
-    while((SysTick->SR & (1 << 0)) != (1 << 0));
-    SysTick->CTLR &= ~(1 << 0);
+    while((SysTick->CNT - start) < i);
 }
 
 /*********************************************************************
@@ -66,17 +80,28 @@ void Delay_Us(uint32_t n)
  */
 void Delay_Ms(uint32_t n)
 {
-    uint32_t i;
-
-    SysTick->SR &= ~(1 << 0);
-    i = (uint32_t)n * p_ms;
+    while(n--)
+        Delay_Us(1000);
+}
 
-    SysTick->CMP = i;
-    SysTick->CNT = 0;
-    SysTick->CTLR |=(1 << 0);
+/*********************************************************************
+ * @fn      Millis
+ *
+ * @brief   Milliseconds since Delay_Init().  SysTick wraps every
+ *          2^32 / HCLK seconds (~89s at 48MHz), so call at least
+ *          that often (the main loop does).  Not for use from interrupts.
+ *
+ * @return  Milliseconds
+ */
+uint32_t Millis(void)
+{
+    static uint32_t ms_count = 0;
+    static uint32_t ms_last = 0;
+    uint32_t elapsed = (SysTick->CNT - ms_last) / p_ms;
 
-    while((SysTick->SR & (1 << 0)) != (1 << 0));
-    SysTick->CTLR &= ~(1 << 0);
+    ms_count += elapsed;
+    ms_last += elapsed * p_ms;
+    return ms_count;
 }
 
 /*********************************************************************
@@ -217,6 +242,12 @@ int _write(int fd, char *buf, int size)
     return writeSize;
 }
 
+#if MALLOC_DISABLE
+/* Absolute marker symbol, Ld/Link.ld fails the link if it finds malloc,
+ * calloc, realloc or _malloc_r pulled from newlib next to it */
+__asm__(".global _malloc_disabled\n.set _malloc_disabled, 1");
+#endif
+
 /*********************************************************************
  * @fn      _sbrk
  *
@@ -231,6 +262,10 @@ void *_sbrk(ptrdiff_t incr)
     extern char _heap_end[];
     static char *curbrk = _end;
 
+#if MALLOC_DISABLE
+    if (incr)
+    return NULL - 1;
+#endif
     if ((curbrk + incr < _end) || (curbrk + incr > _heap_end))
     return NULL - 1;
 
@@ -39,9 +39,19 @@
 #define SDI_PRINT   SDI_PR_CLOSE
 #endif
 
+/* Heap Definition, 1: _sbrk() refuses every request, newlib malloc always
+ * fails, and linking malloc, calloc, realloc or _malloc_r (newlib stdio
+ * buffers) fails the link (Ld/Link.ld).  Nothing in the tree uses the heap,
+ * the fixed-block pools in User/pool.h are there for code that would. */
+#ifndef MALLOC_DISABLE
+#define MALLOC_DISABLE   0
+#endif
+
 void Delay_Init(void);
+void Delay_Update(void);
 void Delay_Us(uint32_t n);
 void Delay_Ms(uint32_t n);
+uint32_t Millis(void);
 void USART_Printf_Init(uint32_t baudrate);
 void SDI_Printf_Enable(void);
 
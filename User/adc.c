@@ -0,0 +1,171 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : adc.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : ADC1 acquisition with Vrefint based supply compensation
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  The ADC converts relative to VDD.  When VDD drifts, every reading drifts with it.
+  The internal reference (Vrefint, channel 8) is fixed, so sampling it gives us VDD:
+      VDD = ADC_VREFINT_MV * ADC_FULL_SCALE / raw_vref
+  From VDD, two Q16 constants are cached.  Each reading is then corrected with a
+  single multiply and shift, see adc_correct() and adc_to_mv() in adc.h.
+
+  ADC channel pins:
+  A0: PA2, A1: PA1, A2: PC4, A3: PD2, A4: PD3, A5: PD5, A6: PD6, A7: PD4
+  Note: PD5/PD6 are used by the USART, PD2 by the servo PWM output
+*/
+
+#include <stdlib.h>
+#include "debug.h"
+#include "command_line.h"
+#include "adc.h"
+
+// Cached correction constants, Q16, default to "VDD is nominal"
+uint32_t adc_gain = (1UL << ADC_GAIN_SHIFT);
+uint32_t adc_mv_scale = ((uint32_t)ADC_VDD_NOMINAL_MV << ADC_GAIN_SHIFT) / ADC_FULL_SCALE;
+
+static uint16_t vdd_mv = ADC_VDD_NOMINAL_MV;
+
+typedef struct {
+    GPIO_TypeDef * port;
+    uint16_t pin;
+} ADC_PIN;
+
+static const ADC_PIN adc_pins[] = {
+    {GPIOA, GPIO_Pin_2}, // A0
+    {GPIOA, GPIO_Pin_1}, // A1
+    {GPIOC, GPIO_Pin_4}, // A2
+    {GPIOD, GPIO_Pin_2}, // A3
+    {GPIOD, GPIO_Pin_3}, // A4
+    {GPIOD, GPIO_Pin_5}, // A5
+    {GPIOD, GPIO_Pin_6}, // A6
+    {GPIOD, GPIO_Pin_4}, // A7
+};
+
+/*********************************************************************
+ * @fn      adc_init
+ *
+ * @brief   Initializes ADC1 for single software triggered conversions,
+ *          runs the reset/start calibration sequence, then samples
+ *          Vrefint to compute VDD and the cached correction constants.
+ *
+ * @return  none
+ */
+void adc_init(void)
+{
+    ADC_InitTypeDef ADC_InitStructure = {0};
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1, ENABLE);
+    RCC_ADCCLKConfig(RCC_PCLK2_Div8); // 48MHz / 8 = 6MHz ADC clock
+
+    ADC_DeInit(ADC1);
+    ADC_InitStructure.ADC_Mode = ADC_Mode_Independent;
+    ADC_InitStructure.ADC_ScanConvMode = DISABLE;
+    ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+    ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_None;
+    ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
+    ADC_InitStructure.ADC_NbrOfChannel = 1;
+    ADC_Init(ADC1, &ADC_InitStructure);
+
+    ADC_Calibration_Vol(ADC1, ADC_CALVOL_50PERCENT);
+    ADC_Cmd(ADC1, ENABLE);
+
+    ADC_ResetCalibration(ADC1);
+    while(ADC_GetResetCalibrationStatus(ADC1));
+    ADC_StartCalibration(ADC1);
+    while(ADC_GetCalibrationStatus(ADC1));
+
+    adc_vdd_update();
+}
+
+/*********************************************************************
+ * @fn      adc_vdd_update
+ *
+ * @brief   Sample Vrefint, compute VDD, and refresh the cached
+ *          correction constants.  Call again to track supply drift.
+ *
+ * @return  none
+ */
+void adc_vdd_update(void)
+{
+    uint32_t sum = 0;
+    for(int i = 0; i < ADC_VREF_SAMPLES; i++)
+        sum += adc_read_raw(ADC_Channel_Vrefint);
+    if(!sum) return; // Not a sane reading, keep previous constants
+
+    // VDD = Vref * full_scale / raw, with raw averaged over ADC_VREF_SAMPLES
+    uint32_t mv = ((uint32_t)ADC_VREFINT_MV * ADC_FULL_SCALE * ADC_VREF_SAMPLES + sum / 2) / sum;
+    vdd_mv = (uint16_t)mv;
+    adc_gain = (mv << ADC_GAIN_SHIFT) / ADC_VDD_NOMINAL_MV;
+    adc_mv_scale = (mv << ADC_GAIN_SHIFT) / ADC_FULL_SCALE;
+}
+
+// Return most recent VDD measurement, in millivolts
+uint16_t adc_vdd_mv(void)
+{
+    return vdd_mv;
+}
+
+// Configure the GPIO pin associated with channel as an analog input
+// Return 0 on success, -1 for invalid channel
+int adc_channel_config(uint8_t channel)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+
+    if(channel == ADC_Channel_Vrefint || channel == ADC_Channel_Vcalint) return 0; // internal
+    if(channel >= sizeof(adc_pins) / sizeof(adc_pins[0])) return -1;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOC | RCC_APB2Periph_GPIOD, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = adc_pins[channel].pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+    GPIO_Init(adc_pins[channel].port, &GPIO_InitStructure);
+    return 0;
+}
+
+// Perform a single conversion, returning the uncorrected 10-bit result
+uint16_t adc_read_raw(uint8_t channel)
+{
+    ADC_RegularChannelConfig(ADC1, channel, 1, ADC_SampleTime_241Cycles);
+    ADC_SoftwareStartConvCmd(ADC1, ENABLE);
+    while(!ADC_GetFlagStatus(ADC1, ADC_FLAG_EOC));
+    return ADC_GetConversionValue(ADC1);
+}
+
+// Perform a single conversion, returning the result scaled to ADC_VDD_NOMINAL_MV supply
+uint16_t adc_read(uint8_t channel)
+{
+    return adc_correct(adc_read_raw(channel));
+}
+
+// Perform a single conversion, returning the result in millivolts
+uint16_t adc_read_mv(uint8_t channel)
+{
+    return adc_to_mv(adc_read_raw(channel));
+}
+
+// Measure and display supply voltage
+int cl_vdd(void)
+{
+    adc_vdd_update();
+    printf("VDD: %u mV, gain: 0x%05X, mV/count: 0x%05X (Q16)\r\n", adc_vdd_mv(), adc_gain, adc_mv_scale);
+    return 0;
+}
+
+// Read an ADC channel, displaying raw, corrected, and millivolt values
+int cl_adc(void)
+{
+    uint8_t channel = (uint8_t) strtol(argv[1], NULL, 0);
+    if(adc_channel_config(channel)) {
+        printf("Invalid channel: %s\r\n", argv[1]);
+        return 1;
+    }
+    uint16_t raw = adc_read_raw(channel);
+    printf("ADC%u raw: %u, corrected: %u, %u mV\r\n", channel, raw, adc_correct(raw), adc_to_mv(raw));
+    return 0;
+}
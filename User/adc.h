@@ -0,0 +1,46 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : adc.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : ADC1 acquisition with Vrefint based supply compensation
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_ADC_H_
+#define USER_ADC_H_
+
+#include "ch32v00x.h"
+
+#define ADC_FULL_SCALE       1023   // 10-bit converter
+#define ADC_VREFINT_MV       1200   // Internal reference, typical, see datasheet
+#define ADC_VDD_NOMINAL_MV   3300   // Corrected readings are scaled to this supply
+#define ADC_VREF_SAMPLES     8      // Vrefint samples averaged when computing VDD
+#define ADC_GAIN_SHIFT       16     // Q16 fixed point for cached correction constants
+
+void     adc_init(void);
+void     adc_vdd_update(void);
+uint16_t adc_vdd_mv(void);
+int      adc_channel_config(uint8_t channel);
+uint16_t adc_read_raw(uint8_t channel);
+uint16_t adc_read(uint8_t channel);
+uint16_t adc_read_mv(uint8_t channel);
+
+// Cached correction, single multiply-shift per sample
+// adc_gain: VDD / ADC_VDD_NOMINAL_MV, Q16
+// adc_mv_scale: VDD / ADC_FULL_SCALE, Q16 (millivolts per count)
+extern uint32_t adc_gain;
+extern uint32_t adc_mv_scale;
+
+static inline uint16_t adc_correct(uint16_t raw)
+{
+    return (uint16_t)((raw * adc_gain) >> ADC_GAIN_SHIFT);
+}
+
+static inline uint16_t adc_to_mv(uint16_t raw)
+{
+    return (uint16_t)((raw * adc_mv_scale) >> ADC_GAIN_SHIFT);
+}
+
+#endif /* USER_ADC_H_ */
@@ -0,0 +1,145 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : bench.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Command line parser and dispatch throughput benchmark
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  "bench [iterations]" times cl_parseArgcArgv() plus the command table
+  lookup, cl_find_command(), for a set of representative lines, with
+  interrupts disabled, and reports cycles per line and lines per second at
+  the current HCLK.  Commands are looked up but not executed.
+
+  The parser writes into its input, so each pass copies the line into a
+  buffer first.  The cost of the copy alone is measured and subtracted.
+  The lines and buffers live in the shared scratch buffer (scratch.h)
+  while the command runs.
+
+  Cases:
+    short     three words, first part of the table
+    quoted    double quoted arguments with spaces
+    maxwords  more words than MAXWORDS, the parser stops early
+    full      MAXSERIALBUF - 1 characters, many short words
+    first     first table entry
+    last      last table entry, longest successful search
+    unknown   not in the table, every entry compared
+
+  Runs the same on target and in the host simulator (tools/host), where
+  SysTick follows host time.  Under tools/rvsim the counts are the
+  simulator's cycle model.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "prof.h"
+#include "wdog.h"
+#include "scratch.h"
+
+#define BENCH_DEFAULT_ITERATIONS  100
+#define BENCH_CHUNK               100   // iterations per interrupts-off span, well inside the WWDG's 43 ms
+
+typedef struct {
+    const char * name;
+    const char * line;
+} BENCH_CASE;
+
+// In the scratch buffer, SCRATCH_BENCH
+typedef struct {
+    char   last[MAXSERIALBUF / 2];  // last table entry and " 1"
+    char   full[MAXSERIALBUF];      // full input buffer
+    char   buffer[MAXSERIALBUF];    // parser input
+    char * words[MAXWORDS];
+} BENCH_SCRATCH;
+
+_Static_assert(sizeof(BENCH_SCRATCH) <= SCRATCH_SIZE, "BENCH_SCRATCH: larger than the scratch buffer");
+
+// NULL: built at run time, see bench_build_lines()
+static const BENCH_CASE bench_cases[] = {
+    {"short",    "add 1 2"},
+    {"quoted",   "set name \"quoted value with spaces\" \"x\""},
+    {"maxwords", "a b c d e f g h i j k l m n"},
+    {"full",     NULL},
+    {"first",    "?"},
+    {"last",     NULL},
+    {"unknown",  "nosuchcommand arg1 arg2"},
+};
+#define BENCH_CASES  (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static BENCH_SCRATCH * bench;
+static volatile int bench_sink; // keeps results live
+
+// SysTick counts for iterations passes over line, parse 0: copy only.
+// Interrupts are off in chunks, the watchdog is fed between them.
+static uint32_t bench_time(const char * line, uint32_t iterations, int parse)
+{
+    uint32_t ticks = 0;
+    while(iterations) {
+        uint32_t n = (iterations < BENCH_CHUNK) ? iterations : BENCH_CHUNK;
+        __disable_irq();
+        uint32_t start = PROF_NOW();
+        for(uint32_t i = 0; i < n; i++) {
+            strcpy(bench->buffer, line);
+            if(parse) {
+                int words = cl_parseArgcArgv(bench->buffer, bench->words, MAXWORDS);
+                bench_sink = words ? cl_find_command(bench->words[0]) : -1;
+            }
+        }
+        ticks += PROF_NOW() - start;
+        __enable_irq();
+        wdog_kick(); // iteration count set by the user
+        iterations -= n;
+    }
+    return ticks;
+}
+
+// Lines that depend on the build: last table entry, a full input buffer
+static void bench_build_lines(void)
+{
+    int last = 0;
+    while(cl_command_name(last + 1)) last++;
+    strncpy(bench->last, cl_command_name(last), sizeof(bench->last) - 3);
+    bench->last[sizeof(bench->last) - 3] = 0;
+    strcat(bench->last, " 1");
+
+    for(int i = 0; i < MAXSERIALBUF - 1; i++)
+        bench->full[i] = (i & 1) ? ' ' : (char)('a' + (i / 2) % 26);
+    bench->full[MAXSERIALBUF - 1] = 0;
+}
+
+// Time the parser and table lookup for each case, display cycles per line
+int cl_bench(void)
+{
+    uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+    if(argc > 1) iterations = strtoul(argv[1], NULL, 0);
+    if(!iterations || iterations > 10000) {
+        printf("Iterations: 1 to 10000\r\n");
+        return 1;
+    }
+
+    bench = scratch_take(SCRATCH_BENCH);
+    bench_build_lines();
+    printf("%u iterations, %u MHz, parse + lookup, copy subtracted\r\n", iterations,
+           SystemCoreClock / 1000000);
+    printf("case      words  cycles/line  lines/sec\r\n");
+    for(unsigned c = 0; c < BENCH_CASES; c++) {
+        const char * line = bench_cases[c].line;
+        if(!line) line = strcmp(bench_cases[c].name, "full") ? bench->last : bench->full;
+        uint32_t copy = bench_time(line, iterations, 0);
+        uint32_t total = bench_time(line, iterations, 1);
+        uint32_t cycles = (total > copy ? total - copy : 0) / iterations;
+
+        strcpy(bench->buffer, line);
+        int words = cl_parseArgcArgv(bench->buffer, bench->words, MAXWORDS);
+        printf("%-9s %5d  %11u  ", bench_cases[c].name, words, cycles);
+        if(cycles) printf("%9u\r\n", SystemCoreClock / cycles);
+        else printf("        -\r\n"); // below the timer resolution
+    }
+    return 0;
+}
@@ -8,6 +8,7 @@
  * SPDX-License-Identifier: Apache-2.0
  *******************************************************************************/
 #include <ch32v00x_it.h>
+#include "wdog.h"
 
 void NMI_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void HardFault_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
@@ -27,11 +28,14 @@ void NMI_Handler(void)
  * @fn      HardFault_Handler
  *
  * @brief   This function handles Hard Fault exception.
+ *          Snapshot for the "crash" command, then reset.
  *
  * @return  none
  */
 void HardFault_Handler(void)
 {
+  wdog_capture(WDOG_CRASH_FAULT, __get_SP());
+  PFIC->CFGR = NVIC_KEY3 | 0x80; // software reset
   while (1)
   {
   }
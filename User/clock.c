@@ -0,0 +1,171 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : clock.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Runtime system clock switching with peripheral retiming
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  system_ch32v00x.c selects the reset clock at compile time.  clock_set()
+  switches at run time between:
+      8MHz   HSI (24MHz) / 3, or HSE / 3
+      24MHz  HSI, or HSE (24MHz crystal on PA1/PA2)
+      48MHz  PLL, HSI * 2 or HSE * 2
+  The core runs from HSI while the PLL and prescaler are changed.  Flash wait
+  states are 1 during the switch and above 24MHz, 0 otherwise.
+
+  Modules that derive settings from the clock register a CLOCK_CALLBACK,
+  usually in their init function.  After the switch SystemCoreClock is
+  recomputed and every callback runs, delays first:
+      Delay_Update()         debug.c, p_us / p_ms
+      usart_clock_update()   debug2.c, USART1 baud divider
+      i2c_clock_update()     i2c.c, I2C1 CCR and FREQ
+      servo_clock_update()   command_line.c, TIM1 prescaler for 1us ticks
+      edge_clock_update()    edge.c, debounce in SysTick counts
+      wdog_clock_update()    wdog.c, WWDG early warnings per period
+  SPI users (ws2812.c, nor.c) compute their prescaler when they start.
+
+  Standby ("sleep <ms>", power.c) wakes on HSI.  power_standby() calls
+  clock_restore(), which runs clock_set() with the clock in use before, so
+  the callbacks run the same way as for "clock".
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "clock.h"
+
+extern void Delay_Update(void); // debug.c
+
+static CLOCK_CALLBACK clock_callbacks[CLOCK_CALLBACKS] = {Delay_Update};
+
+// Reset clock, keep in step with SYSCLK_FREQ_* in system_ch32v00x.c
+#define CLOCK_RESET_MHZ    48
+#define CLOCK_RESET_HSE    0
+
+static uint8_t clock_mhz = CLOCK_RESET_MHZ;     // last clock_set()
+static uint8_t clock_hse = CLOCK_RESET_HSE;
+
+/*********************************************************************
+ * @fn      clock_register
+ *
+ * @brief   Add a callback to run after each clock change.  Registering
+ *          the same callback again has no effect.
+ *
+ * @return  CLOCK_ERROR_SUCCESS or CLOCK_ERROR_FULL
+ */
+int clock_register(CLOCK_CALLBACK callback)
+{
+    for(int i = 0; i < CLOCK_CALLBACKS; i++) {
+        if(clock_callbacks[i] == callback) return CLOCK_ERROR_SUCCESS;
+        if(!clock_callbacks[i]) {
+            clock_callbacks[i] = callback;
+            return CLOCK_ERROR_SUCCESS;
+        }
+    }
+    return CLOCK_ERROR_FULL;
+}
+
+// Select system clock source, wait until in use
+static void clock_switch(uint32_t sw)
+{
+    RCC->CFGR0 = (RCC->CFGR0 & ~RCC_SW) | sw;
+    while((RCC->CFGR0 & RCC_SWS) != (sw << 2));
+}
+
+/*********************************************************************
+ * @fn      clock_set
+ *
+ * @brief   Switch the system clock, then run the registered callbacks.
+ *          Console output is drained first, as the baud rate changes.
+ *
+ * @param   mhz - 8, 24 or 48
+ *          hse - 0: HSI, 1: HSE
+ *
+ * @return  CLOCK_ERROR
+ */
+int clock_set(uint32_t mhz, uint8_t hse)
+{
+    if(mhz != 8 && mhz != 24 && mhz != 48) return CLOCK_ERROR_INVALID;
+
+    if(hse && !(RCC->CTLR & RCC_HSERDY)) {
+        // Crystal on PA1/PA2, then start the oscillator
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+        GPIO_PinRemapConfig(GPIO_Remap_PA1_2, ENABLE);
+        RCC->CTLR |= RCC_HSEON;
+        for(uint32_t count = 0; !(RCC->CTLR & RCC_HSERDY); count++) {
+            if(count >= HSE_STARTUP_TIMEOUT) {
+                RCC->CTLR &= ~RCC_HSEON;
+                return CLOCK_ERROR_HSE;
+            }
+        }
+    }
+
+    Millis(); // fold elapsed SysTick counts at the old rate
+    while(USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET);
+
+    __disable_irq();
+    FLASH->ACTLR = (FLASH->ACTLR & ~FLASH_ACTLR_LATENCY) | FLASH_ACTLR_LATENCY_1;
+    clock_switch(RCC_SW_HSI);
+    RCC->CTLR &= ~RCC_PLLON;
+    RCC->CFGR0 = (RCC->CFGR0 & ~RCC_HPRE) | ((mhz == 8) ? RCC_HPRE_DIV3 : RCC_HPRE_DIV1);
+
+    if(mhz == 48) {
+        RCC->CFGR0 = (RCC->CFGR0 & ~RCC_PLLSRC) | (hse ? RCC_PLLSRC_HSE_Mul2 : RCC_PLLSRC_HSI_Mul2);
+        RCC->CTLR |= RCC_PLLON;
+        while(!(RCC->CTLR & RCC_PLLRDY));
+        clock_switch(RCC_SW_PLL);
+    } else {
+        if(hse) clock_switch(RCC_SW_HSE);
+        FLASH->ACTLR = (FLASH->ACTLR & ~FLASH_ACTLR_LATENCY) | FLASH_ACTLR_LATENCY_0;
+    }
+    if(!hse) RCC->CTLR &= ~RCC_HSEON;
+
+    SystemCoreClockUpdate();
+    clock_mhz = (uint8_t)mhz;
+    clock_hse = hse;
+    for(int i = 0; i < CLOCK_CALLBACKS && clock_callbacks[i]; i++)
+        clock_callbacks[i]();
+    __enable_irq();
+    return CLOCK_ERROR_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      clock_restore
+ *
+ * @brief   Switch back to the last clock_set() clock, or the reset clock,
+ *          after standby woke the part on HSI.  If HSE no longer starts,
+ *          fall back to HSI at the same frequency.
+ *
+ * @return  CLOCK_ERROR
+ */
+int clock_restore(void)
+{
+    int rc = clock_set(clock_mhz, clock_hse);
+    if(CLOCK_ERROR_HSE == rc) rc = clock_set(clock_mhz, 0);
+    return rc;
+}
+
+// clock                  -- display system clock
+// clock 8|24|48 [hse]    -- switch system clock
+int cl_clock(void)
+{
+    if(argc > 1) {
+        uint8_t hse = (argc > 2 && strcmp(argv[2], "hse") == 0);
+        int rc = clock_set(strtoul(argv[1], NULL, 0), hse);
+        if(CLOCK_ERROR_INVALID == rc) printf("Usage: clock [8|24|48] [hse]\r\n");
+        else if(CLOCK_ERROR_HSE == rc) printf("HSE not ready, clock unchanged\r\n");
+        if(rc) return 1;
+    }
+
+    static const char * const sources[] = {"HSI", "HSE", "PLL"};
+    uint32_t sws = (RCC->CFGR0 & RCC_SWS) >> 2;
+    printf("SYSCLK: %s, HCLK: %u Hz, flash latency: %u\r\n", (sws < 3) ? sources[sws] : "?",
+           SystemCoreClock, FLASH->ACTLR & FLASH_ACTLR_LATENCY);
+    return 0;
+}
@@ -0,0 +1,32 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : clock.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Runtime system clock switching with peripheral retiming
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_CLOCK_H_
+#define USER_CLOCK_H_
+
+#include "ch32v00x.h"
+
+#define CLOCK_CALLBACKS    7       // registered retiming callbacks, including delays
+
+typedef enum {
+    CLOCK_ERROR_SUCCESS = 0,
+    CLOCK_ERROR_INVALID = -1,  // unsupported frequency
+    CLOCK_ERROR_HSE     = -2,  // HSE did not start, clock unchanged
+    CLOCK_ERROR_FULL    = -3,  // callback table full
+} CLOCK_ERROR;
+
+// Called after SystemCoreClock changes, reprograms clock derived settings
+typedef void (*CLOCK_CALLBACK)(void);
+
+int clock_register(CLOCK_CALLBACK callback);
+int clock_set(uint32_t mhz, uint8_t hse);
+int clock_restore(void);
+
+#endif /* USER_CLOCK_H_ */
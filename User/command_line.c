@@ -19,6 +19,13 @@
 #include "command_line.h"
 #include "i2c.h"
 #include "core_riscv.h"
+#include "kvstore.h"
+#include "evlog.h"
+#include "prof.h"
+#include "clock.h"
+#include "enc.h"
+#include "wdog.h"
+#include "ds3231.h"
 
 // Typedefs
 typedef struct {
@@ -38,9 +45,34 @@ const COMMAND_ITEM cmd_table[] = {
     {"clocks",    "display clock control registers",              1, cl_clocks},
     {"reset",     "reset processor",                              1, cl_reset},
     {"resetcause","display reset cause flag",                     1, cl_reset_cause},
-    {"servo",     "0.8ms, 1.5ms, 2.2ms pulse widths",             1, cl_servo},
+    {"servo",     "pwm_min, center, pwm_max pulse widths",        1, cl_servo},
     {"i2cscan",   "scan I2C1, showing active devices",            1, cl_i2cscan},
     {"temp",      "access external DS3231, read temperature",     1, cl_ds3231_temperature},
+    {"vdd",       "measure supply voltage using Vrefint",         1, cl_vdd},
+    {"adc",       "adc <channel>, read corrected ADC value",      2, cl_adc},
+    {"opa",       "opa on [p] [n] | off | read, op-amp",          2, cl_opa},
+    {"spi",       "spi init <mode> <div> <bits> | spi <hex>...",  2, cl_spi},
+    {"nor",       "nor id | read | write | erase, SPI NOR flash", 2, cl_nor},
+    {"led",       "led <count> fill <rgb> | off | rainbow [n]",   3, cl_led},
+    {"set",       "set <key> <value>, change setting",            3, cl_set},
+    {"get",       "get [key], display settings",                  1, cl_get},
+    {"save",      "save changed settings to flash",               1, cl_save},
+    {"log",       "log [flush], display event log",               1, cl_log},
+    {"update",    "update [boot], firmware update over USART",    1, cl_update},
+    {"rambench",  "rambench [n], flash vs RAM execution time",    1, cl_rambench},
+    {"mem",       "RAM usage and stack high-water mark",          1, cl_mem},
+    {"pool",      "pool [reset], block pool statistics",          1, cl_pool},
+    {"prof",      "prof [reset], execution time statistics",      1, cl_prof},
+    {"lat",       "lat fast|sw [group] [load], IRQ latency test", 2, cl_lat},
+    {"sleep",     "sleep [ms], residency, or standby for ms",     1, cl_sleep},
+    {"clock",     "clock [8|24|48] [hse], system clock",          1, cl_clock},
+    {"bench",     "bench [n], parser and dispatch throughput",    1, cl_bench},
+    {"la",        "la c|d <hz> [pin edge [pre%]] | dump",         2, cl_la},
+    {"edge",      "edge [c|d<pin> rise|fall|both [us]|off|hist]", 1, cl_edge},
+    {"enc",       "enc [start [1|2] | stop | zero], encoder",     1, cl_enc},
+    {"wdog",      "wdog [hang], watchdog and last culprit",       1, cl_wdog},
+    {"crash",     "crash [clear|fault], last stall or fault",     1, cl_crash},
+    {"rtc",       "rtc [set|alarm|int|sqw ...], DS3231 clock",    1, cl_rtc},
     {NULL,NULL,0,NULL}, /* end of table */
 };
 
@@ -101,6 +133,27 @@ void cl_loop(void)
   return;
 } // cl_loop()
 
+// Look up a command name in the table, return its index or -1 if not found
+// Linear search, cost grows with the position of the command in the table
+int cl_find_command(const char * name)
+{
+    for (int cmdIndex = 0; cmd_table[cmdIndex].function; cmdIndex++) {
+        if (strcmp(name, cmd_table[cmdIndex].command) == 0)
+            return cmdIndex;
+    }
+    return -1;
+}
+
+// Name of table entry index, NULL past the end of the table
+const char * cl_command_name(int index)
+{
+    for (int cmdIndex = 0; cmd_table[cmdIndex].function; cmdIndex++) {
+        if (cmdIndex == index)
+            return cmd_table[cmdIndex].command;
+    }
+    return NULL;
+}
+
 void cl_process_buffer(void)
 {
     argc = cl_parseArgcArgv(buffer, argv, MAXWORDS);
@@ -110,26 +163,24 @@ void cl_process_buffer(void)
     if (argc) {
         // At least one "word" / argument found
         // See if command has a match in the command table
-        // If null function pointer found, exit for-loop
-        int cmdIndex;
-        for (cmdIndex = 0; cmd_table[cmdIndex].function; cmdIndex++) {
-            if (strcmp(argv[0], cmd_table[cmdIndex].command) == 0) {
-                // We found a match in the table
-                // Enough arguments?
-                if (argc < cmd_table[cmdIndex].arg_cnt) {
-                    printf("\r\nInvalid Arg cnt: %d Expected: %d\r\n", argc - 1,
-                            cmd_table[cmdIndex].arg_cnt - 1);
-                    break;
-                }
-                // Call the function associated with the command
-                (*cmd_table[cmdIndex].function)();
-                break; // exit for-loop
-            }
-        } // for-loop
-          // If we compared all the command strings and didn't find the command, or we want to fake that event
-        if (!cmd_table[cmdIndex].command) {
+        int cmdIndex = cl_find_command(argv[0]);
+        if (cmdIndex < 0) {
             printf("Command \"%s\" not found\r\n", argv[0]);
+            return;
+        }
+        // Enough arguments?
+        if (argc < cmd_table[cmdIndex].arg_cnt) {
+            printf("\r\nInvalid Arg cnt: %d Expected: %d\r\n", argc - 1,
+                    cmd_table[cmdIndex].arg_cnt - 1);
+            return;
         }
+        // Call the function associated with the command, recording its execution time
+        // and its name, kept across a watchdog reset
+        uint32_t start = PROF_NOW();
+        wdog_command(cmd_table[cmdIndex].command);
+        (*cmd_table[cmdIndex].function)();
+        wdog_command(NULL);
+        prof_command(cmd_table[cmdIndex].command, PROF_NOW() - start);
     } // At least one "word" / argument found
 }
 
@@ -300,6 +351,7 @@ int cl_clocks(void)
 //7 RESETSYS WO System reset
 int cl_reset(void) {
     printf("%s\r\n",__func__);
+    evlog_flush(); // keep pending events
     Delay_Ms(10);
     PFIC->CFGR = NVIC_KEY3 | 0x80;
     return 0;
@@ -322,6 +374,7 @@ int cl_reset_cause(void)
     if(RCC->RSTSCKR & RCC_SFTRSTF)  printf("SFTRSTF\r\n");
     if(RCC->RSTSCKR & RCC_PORRSTF)  printf("PORRSTF\r\n");
     if(RCC->RSTSCKR & RCC_PINRSTF)  printf("PINRSTF\r\n");
+    if(RCC->RSTSCKR & (RCC_IWDGRSTF | RCC_WWDGRSTF)) wdog_report(); // task and command that starved it
 
     // Clear reset flags for next time
     RCC->RSTSCKR |= RCC_RMVF;
@@ -395,19 +448,35 @@ void TIM1_PWMOut_Init(u16 arr, u16 psc, u16 ccp)
     TIM_Cmd( TIM1, ENABLE );
 }
 
-// Create 50Hz (20.0ms) pulse train, with 1.0ms, 1.5ms, 2.0ms pulse width
+// Clock change callback, keep TIM1 at 1us ticks
+static void servo_clock_update(void)
+{
+    TIM1->PSC = (uint16_t)(SystemCoreClock / 1000000 - 1);
+}
+
+// Create 50Hz (20.0ms) pulse train, with minimum, center, maximum pulse width
+// Limits default to 0.8ms and 2.2ms, see "set pwm_min" and "set pwm_max"
 int cl_servo(void)
 {
-    // Initialize PWM for 50Hz (20ms period) 0.8ms high PWM
-    TIM1_PWMOut_Init( 20000, 48-1, 800); // 0.8ms (1us units for ccp)
+    uint16_t pwm_min = (uint16_t)kv_get(KV_KEY_PWM_MIN, 800);
+    uint16_t pwm_max = (uint16_t)kv_get(KV_KEY_PWM_MAX, 2200);
+
+    if(enc_timer() == TIM1) {
+        printf("TIM1 in use by enc\r\n");
+        return 1;
+    }
+
+    // Initialize PWM for 50Hz (20ms period), pwm_min high PWM
+    TIM1_PWMOut_Init( 20000, SystemCoreClock / 1000000 - 1, pwm_min); // 1us units for ccp
+    clock_register(servo_clock_update);
     printf("TIM1->CH1CVR: %u\r\n",TIM1->CH1CVR);
-    Delay_Ms(2000);
+    wdog_delay_ms(2000);
 
-    TIM1->CH1CVR = 1500; // 1.5ms
+    TIM1->CH1CVR = (pwm_min + pwm_max) / 2; // center
     printf("TIM1->CH1CVR: %u\r\n",TIM1->CH1CVR);
-    Delay_Ms(2000);
+    wdog_delay_ms(2000);
 
-    TIM1->CH1CVR = 2200; // 2.2ms
+    TIM1->CH1CVR = pwm_max;
     printf("TIM1->CH1CVR: %u\r\n",TIM1->CH1CVR);
     //Delay_Ms(2000);
     return 0;
@@ -420,39 +489,20 @@ int cl_i2cscan(void)
     return 0;
 }
 
-#define I2C_ADDRESS_DS3231  0x68   // 7-bit I2C address for DS3231
-
-// If DS3231 present, poll and display the temperature each second
+// Display the DS3231 temperature, from its own conversion every 64 seconds
 int cl_ds3231_temperature(void)
 {
-    if(I2C_ERROR_SUCCESS != i2c_device_detect(I2C_ADDRESS_DS3231)) {
+    int16_t quarters;
+
+    if(I2C_ERROR_SUCCESS != i2c_device_detect(DS3231_ADDRESS)) {
         printf("DS3231 Not Found !\r\n");
         return I2C_ERROR_ACK;
     }
-    printf("%s, Continuously read DS3231 temperature until reset\r\n",__func__);
-    while(1) {
-        // Force a temperature conversion, write 0x3C to control register, 0x0E (set CONV bit, BIT5)
-        uint8_t reg=0x0E;
-        uint8_t control_reg[2] = {0x0E,0x3C};
-        i2c_write(I2C_ADDRESS_DS3231,control_reg,sizeof(control_reg));
-
-        // Read temperature registers, 0x11, 0x12
-        reg=0x11; // Temperature, MSB (Celcius)
-        uint8_t temp_reg[2] = {0,0};
-        i2c_write(I2C_ADDRESS_DS3231,&reg,sizeof(reg));
-        i2c_read(I2C_ADDRESS_DS3231, temp_reg, sizeof(temp_reg));
-        //printf("temp_reg0: %02X, temp_reg1: %02X\n",temp_reg[0],temp_reg[1]);
-        // Combine registers into int16_t
-        uint16_t u_temp_c = ((uint16_t)temp_reg[0]<<8) + ((uint16_t)temp_reg[1]);
-        int16_t temp_c = (int16_t)u_temp_c;
-        //printf("u_temp_c: %04X\n",u_temp_c);
-        temp_c /= 64; // convert to 1/4 degree C units
-        printf("Temp: %d %d/4C\r\n",temp_c/4,temp_c%4); // This display method only works for positive temperature values
-
-        // Convert to Fahrenheit
-        //int16_t temp_f = (((int16_t)temp_msb * 18) / 10) + 32 ; // multiply by 1.8, add 32
-        //printf("Temp: %dF\n",temp_f);
-        Delay_Ms(1000);
-    } // while
+    int rc = ds3231_temperature(&quarters);
+    if(I2C_ERROR_SUCCESS != rc) return rc;
+    printf("Temp: ");
+    ds3231_print_temperature(quarters);
+    printf("\r\n");
+    return 0;
 }
 
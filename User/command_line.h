@@ -46,6 +46,8 @@ int cl_parseArgcArgv(char * inBuf,char **words, int count);
 void cl_setup(void);
 void cl_loop(void);
 void cl_process_buffer(void);
+int cl_find_command(const char * name);
+const char * cl_command_name(int index);
 
 // command line functions
 int cl_help(void);
@@ -61,5 +63,30 @@ int cl_reset_cause(void);
 int cl_servo(void);
 int cl_i2cscan(void);
 int cl_ds3231_temperature(void);
+int cl_vdd(void);   // adc.c
+int cl_adc(void);   // adc.c
+int cl_opa(void);   // opa.c
+int cl_spi(void);   // spi.c
+int cl_nor(void);   // nor.c
+int cl_led(void);   // ws2812.c
+int cl_set(void);   // kvstore.c
+int cl_get(void);   // kvstore.c
+int cl_save(void);  // kvstore.c
+int cl_log(void);   // evlog.c
+int cl_update(void); // update.c
+int cl_rambench(void); // rambench.c
+int cl_mem(void);   // mem.c
+int cl_pool(void);  // pool.c
+int cl_prof(void);  // prof.c
+int cl_lat(void);   // lat.c
+int cl_sleep(void); // power.c
+int cl_clock(void); // clock.c
+int cl_bench(void); // bench.c
+int cl_la(void); // la.c
+int cl_edge(void); // edge.c
+int cl_enc(void); // enc.c
+int cl_wdog(void); // wdog.c
+int cl_crash(void); // wdog.c
+int cl_rtc(void); // ds3231.c
 
 #endif // _command_line_h_
@@ -0,0 +1,24 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : crc16.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : CRC-16/CCITT (polynomial 0x1021)
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#include "crc16.h"
+
+// Bitwise CRC-16/CCITT, no table, trades speed for flash space.
+// Start with crc = CRC16_INIT, pass the result back in to continue a CRC.
+uint16_t crc16(uint16_t crc, const void * data, uint32_t count)
+{
+    const uint8_t * p = (const uint8_t *)data;
+    while(count--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for(int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
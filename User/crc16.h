@@ -0,0 +1,20 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : crc16.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : CRC-16/CCITT (polynomial 0x1021)
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_CRC16_H_
+#define USER_CRC16_H_
+
+#include <stdint.h>
+
+#define CRC16_INIT  0xFFFF
+
+uint16_t crc16(uint16_t crc, const void * data, uint32_t count);
+
+#endif /* USER_CRC16_H_ */
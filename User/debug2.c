@@ -10,6 +10,15 @@
  *******************************************************************************/
 
 #include <debug.h>
+#include "clock.h"
+
+static uint32_t usart_baudrate;
+
+// Clock change callback, recompute the USART1 baud divider, 16x oversampling
+static void usart_clock_update(void)
+{
+    USART1->BRR = (uint16_t)((SystemCoreClock + usart_baudrate / 2) / usart_baudrate);
+}
 
 /*********************************************************************
  * @fn      USART_Printf_Init2
@@ -47,6 +56,9 @@ void USART_Printf_Init2(uint32_t baudrate)
 
     USART_Init(USART1, &USART_InitStructure);
     USART_Cmd(USART1, ENABLE);
+
+    usart_baudrate = baudrate;
+    clock_register(usart_clock_update);
 }
 
 /*********************************************************************
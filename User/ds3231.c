@@ -0,0 +1,439 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ds3231.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : DS3231 real time clock, alarms, INT/SQW, HSI discipline
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  rtc                                   time, temperature, INT/SQW and alarms
+  rtc set <yyyy-mm-dd> <hh:mm:ss>
+  rtc alarm 1 <hh:mm:ss> | 2 <hh:mm>    daily alarm on INT, "rtc alarm 1|2 off"
+  rtc int c|d<pin>                      INT/SQW wired to PC<pin> or PD<pin>
+  rtc sqw [trim]                        1 Hz square wave, trim: discipline HSI
+  temp                                  temperature
+
+  The seven time registers are read in one burst, so the fields can't carry
+  between them mid-read.  The DS3231 converts temperature by itself every
+  64 seconds; the registers hold that result, reading them costs an I2C
+  transfer instead of a forced 125 ms conversion.
+
+  INT/SQW is open drain, the pin gets a pull-up and is counted by edge.c
+  (falling edges, edge_enable()), so "edge" and "edge hist" show it too.
+  ds3231_poll(), from the main loop, follows the count with edge_read():
+    alarm mode (INTCN 1)  INT goes low on a match and stays low until the
+                          flag is cleared; the flags are read, cleared and
+                          reported
+    sqw mode (INTCN 0)    1 Hz, with "trim" each period is timed with the
+                          SysTick stamp taken by the EXTI interrupt
+  Discipline: cycles per RTC second minus SystemCoreClock, averaged over
+  RTC_TRIM_SECONDS, is the HSI error.  Beyond RTC_TRIM_DEADBAND_PPM the
+  HSITRIM field (RCC_CTLR) moves one step against it.  A missed edge or a
+  period off by more than 1/RTC_TRIM_GLITCH (clock change) restarts the
+  average.  Not available while running from HSE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "i2c.h"
+#include "edge.h"
+#include "ds3231.h"
+
+#define RTC_NO_LINE  0xFF
+
+static uint8_t  rtc_line = RTC_NO_LINE;   // EXTI line of INT/SQW
+static char     rtc_port;
+static uint8_t  rtc_sqw;                  // INT/SQW is the 1 Hz square wave
+static uint8_t  rtc_trim_on;              // discipline HSI in sqw mode
+static uint32_t rtc_count;                // edge count last seen
+static uint32_t rtc_edge_time;            // SysTick of the last edge
+static uint8_t  rtc_primed;               // rtc_edge_time is valid
+static uint8_t  rtc_trim_n;               // periods in rtc_trim_sum
+static int32_t  rtc_trim_sum;             // cycles
+static int32_t  rtc_ppm;                  // last averaged error
+static uint16_t rtc_trims;                // HSITRIM steps taken
+
+static uint8_t ds3231_bcd(uint8_t value)   { return (uint8_t)(((value / 10) << 4) | (value % 10)); }
+static uint8_t ds3231_binary(uint8_t bcd)  { return (uint8_t)((bcd >> 4) * 10 + (bcd & 0x0F)); }
+
+static int ds3231_read_regs(uint8_t reg, uint8_t * data, uint8_t count)
+{
+    int rc = i2c_write(DS3231_ADDRESS, &reg, 1);
+    if(I2C_ERROR_SUCCESS != rc) return rc;
+    return i2c_read(DS3231_ADDRESS, data, count);
+}
+
+static int ds3231_write_regs(uint8_t reg, const uint8_t * data, uint8_t count)
+{
+    uint8_t buf[8];
+
+    buf[0] = reg;
+    memcpy(&buf[1], data, count);
+    return i2c_write(DS3231_ADDRESS, buf, (uint8_t)(count + 1));
+}
+
+static int ds3231_read_reg(uint8_t reg, uint8_t * value)
+{
+    return ds3231_read_regs(reg, value, 1);
+}
+
+static int ds3231_write_reg(uint8_t reg, uint8_t value)
+{
+    return ds3231_write_regs(reg, &value, 1);
+}
+
+// Set and clear control register bits
+static int ds3231_control(uint8_t set, uint8_t clear)
+{
+    uint8_t control;
+    int rc = ds3231_read_reg(DS3231_REG_CONTROL, &control);
+    if(I2C_ERROR_SUCCESS != rc) return rc;
+    return ds3231_write_reg(DS3231_REG_CONTROL, (uint8_t)((control & ~clear) | set));
+}
+
+static void ds3231_decode_time(const uint8_t * r, DS3231_TIME * time)
+{
+    time->sec = ds3231_binary(r[0] & 0x7F);
+    time->min = ds3231_binary(r[1] & 0x7F);
+    if(r[2] & 0x40) // 12 hour mode, bit 5 is PM
+        time->hour = (uint8_t)(ds3231_binary(r[2] & 0x1F) % 12 + ((r[2] & 0x20) ? 12 : 0));
+    else
+        time->hour = ds3231_binary(r[2] & 0x3F);
+    time->wday = r[3] & 0x07;
+    time->mday = ds3231_binary(r[4] & 0x3F);
+    time->month = ds3231_binary(r[5] & 0x1F);
+    time->year = (uint16_t)(2000 + ds3231_binary(r[6]) + ((r[5] & 0x80) ? 100 : 0));
+}
+
+// Burst read of the seven time registers, returns I2C_ERROR
+int ds3231_read_time(DS3231_TIME * time)
+{
+    uint8_t r[7];
+    int rc = ds3231_read_regs(DS3231_REG_TIME, r, sizeof(r));
+    if(I2C_ERROR_SUCCESS == rc) ds3231_decode_time(r, time);
+    return rc;
+}
+
+// Write the seven time registers (24 hour mode), clear OSF
+int ds3231_set_time(const DS3231_TIME * time)
+{
+    uint8_t r[7];
+    uint8_t status;
+
+    r[0] = ds3231_bcd(time->sec);
+    r[1] = ds3231_bcd(time->min);
+    r[2] = ds3231_bcd(time->hour);
+    r[3] = time->wday;
+    r[4] = ds3231_bcd(time->mday);
+    r[5] = (uint8_t)(ds3231_bcd(time->month) | ((time->year >= 2100) ? 0x80 : 0));
+    r[6] = ds3231_bcd((uint8_t)(time->year % 100));
+    int rc = ds3231_write_regs(DS3231_REG_TIME, r, sizeof(r));
+    if(I2C_ERROR_SUCCESS == rc) rc = ds3231_read_reg(DS3231_REG_STATUS, &status);
+    if(I2C_ERROR_SUCCESS == rc) rc = ds3231_write_reg(DS3231_REG_STATUS, status & (uint8_t)~DS3231_OSF);
+    return rc;
+}
+
+// Last automatic conversion, quarter degrees C, returns I2C_ERROR
+int ds3231_temperature(int16_t * quarters)
+{
+    uint8_t r[2];
+    int rc = ds3231_read_regs(DS3231_REG_TEMP, r, sizeof(r));
+    if(I2C_ERROR_SUCCESS != rc) return rc;
+    *quarters = (int16_t)((int16_t)(((uint16_t)r[0] << 8) | r[1]) >> 6);
+    return I2C_ERROR_SUCCESS;
+}
+
+// "-5.25 C"
+void ds3231_print_temperature(int16_t quarters)
+{
+    uint16_t magnitude = (uint16_t)(quarters < 0 ? -quarters : quarters);
+    printf("%s%u.%02u C", quarters < 0 ? "-" : "", magnitude / 4, (magnitude % 4) * 25);
+}
+
+// Day of week, 1: Sunday
+static uint8_t ds3231_weekday(uint16_t year, uint8_t month, uint8_t mday)
+{
+    static const uint8_t offsets[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    if(month < 3) year--;
+    return (uint8_t)((year + year / 4 - year / 100 + year / 400 + offsets[month - 1] + mday) % 7 + 1);
+}
+
+// Decimal fields separated by any non-digit, "2026-10-18" or "12:34:56"
+static int ds3231_fields(const char * s, uint16_t * fields, int count)
+{
+    int n = 0;
+    while(*s && n < count) {
+        if(*s < '0' || *s > '9') return -1;
+        uint32_t value = 0;
+        for(; *s >= '0' && *s <= '9'; s++)
+            if(value < 10000) value = value * 10 + (uint32_t)(*s - '0');
+        fields[n++] = (uint16_t)value;
+        if(*s) s++; // separator
+    }
+    return (*s) ? -1 : n;
+}
+
+// HSITRIM step when the averaged error is out of the dead band
+static void rtc_discipline(uint32_t edges, uint32_t time)
+{
+    uint32_t last = rtc_edge_time;
+    int32_t glitch = (int32_t)(SystemCoreClock / RTC_TRIM_GLITCH);
+
+    rtc_edge_time = time;
+    if(edges != 1 || !rtc_primed) { // no period to time
+        rtc_primed = 1;
+        return;
+    }
+    int32_t error = (int32_t)(time - last - SystemCoreClock);
+    if(error > glitch || error < -glitch) {
+        rtc_trim_n = 0;
+        rtc_trim_sum = 0;
+        return;
+    }
+    rtc_trim_sum += error;
+    if(++rtc_trim_n < RTC_TRIM_SECONDS) return;
+
+    rtc_ppm = rtc_trim_sum / RTC_TRIM_SECONDS / (int32_t)(SystemCoreClock / 1000000);
+    rtc_trim_n = 0;
+    rtc_trim_sum = 0;
+
+    uint8_t trim = (uint8_t)((RCC->CTLR & RCC_HSITRIM) >> 3);
+    if(rtc_ppm > RTC_TRIM_DEADBAND_PPM && trim > 0) trim--;  // fast
+    else if(rtc_ppm < -RTC_TRIM_DEADBAND_PPM && trim < 31) trim++;
+    else return;
+    RCC_AdjustHSICalibrationValue(trim);
+    rtc_trims++;
+}
+
+/*********************************************************************
+ * @fn      ds3231_poll
+ *
+ * @brief   Follow INT/SQW edges, see the note above.  Called from the
+ *          main loop.
+ *
+ * @return  none
+ */
+void ds3231_poll(void)
+{
+    uint32_t time;
+
+    if(rtc_line == RTC_NO_LINE) return;
+    if(!(edge_lines() & (1 << rtc_line))) { // "edge off"
+        rtc_line = RTC_NO_LINE;
+        rtc_trim_on = 0;
+        return;
+    }
+    uint32_t count = edge_read(rtc_line, &time);
+    if(count == rtc_count) return;
+    uint32_t edges = count - rtc_count;
+    rtc_count = count;
+
+    if(rtc_sqw) {
+        if(rtc_trim_on) rtc_discipline(edges, time);
+        return;
+    }
+
+    uint8_t status;
+    if(I2C_ERROR_SUCCESS != ds3231_read_reg(DS3231_REG_STATUS, &status)) return;
+    uint8_t flags = status & (DS3231_A1F | DS3231_A2F);
+    if(!flags) return;
+    ds3231_write_reg(DS3231_REG_STATUS, status & (uint8_t)~flags); // INT released
+    printf("\r\nRTC alarm%s%s\r\n", (flags & DS3231_A1F) ? " 1" : "", (flags & DS3231_A2F) ? " 2" : "");
+}
+
+static void ds3231_print_alarm(uint8_t alarm, const uint8_t * r, uint8_t enabled)
+{
+    printf("Alarm %u ", alarm);
+    if(alarm == 1) {
+        printf("%02u:%02u:%02u", ds3231_binary(r[2] & 0x3F), ds3231_binary(r[1] & 0x7F), ds3231_binary(r[0] & 0x7F));
+        if(!(r[3] & DS3231_ALARM_MASK)) printf(" day %02X", r[3]);
+    }
+    else {
+        printf("%02u:%02u", ds3231_binary(r[1] & 0x3F), ds3231_binary(r[0] & 0x7F));
+        if(!(r[2] & DS3231_ALARM_MASK)) printf(" day %02X", r[2]);
+    }
+    printf(" %s\r\n", enabled ? "on" : "off");
+}
+
+static int ds3231_status_report(void)
+{
+    static const char * const days[] = {"?", "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    DS3231_TIME t;
+    uint8_t r[DS3231_REG_STATUS + 1]; // time, alarms, control, status
+    int16_t quarters;
+
+    int rc = ds3231_read_regs(DS3231_REG_TIME, r, sizeof(r)); // one burst, time to status
+    if(I2C_ERROR_SUCCESS == rc) rc = ds3231_temperature(&quarters);
+    if(I2C_ERROR_SUCCESS != rc) return rc;
+    ds3231_decode_time(r, &t);
+
+    uint8_t control = r[DS3231_REG_CONTROL];
+    uint8_t status = r[DS3231_REG_STATUS];
+    printf("%04u-%02u-%02u %02u:%02u:%02u %s", t.year, t.month, t.mday, t.hour, t.min, t.sec,
+           days[t.wday & 7]);
+    if(status & DS3231_OSF) printf(", oscillator stopped, time not valid");
+    printf("\r\nTemperature ");
+    ds3231_print_temperature(quarters);
+    printf("\r\n");
+
+    printf("INT/SQW ");
+    if(rtc_line != RTC_NO_LINE) printf("P%c%u ", rtc_port, rtc_line);
+    if(control & DS3231_INTCN)
+        printf("alarms");
+    else
+        printf("%s square wave", (control & DS3231_RS_MASK) ? "fast" : "1 Hz");
+    if(rtc_trim_on)
+        printf(", trim %u, error %d ppm, %u steps", (RCC->CTLR & RCC_HSITRIM) >> 3, rtc_ppm, rtc_trims);
+    printf("\r\n");
+    ds3231_print_alarm(1, &r[DS3231_REG_ALARM1], control & DS3231_A1IE);
+    ds3231_print_alarm(2, &r[DS3231_REG_ALARM2], control & DS3231_A2IE);
+    if(status & (DS3231_A1F | DS3231_A2F))
+        printf("Flags:%s%s\r\n", (status & DS3231_A1F) ? " A1F" : "", (status & DS3231_A2F) ? " A2F" : "");
+    return I2C_ERROR_SUCCESS;
+}
+
+// rtc alarm 1 <hh:mm:ss> | 2 <hh:mm> | 1|2 off
+static int ds3231_alarm_command(void)
+{
+    uint32_t alarm = (argc > 2) ? strtoul(argv[2], NULL, 0) : 0;
+    uint16_t f[3];
+    int n = (argc > 3) ? ds3231_fields(argv[3], f, 3) : -1;
+    uint8_t enable = (alarm == 1) ? DS3231_A1IE : DS3231_A2IE;
+    uint8_t flag = (alarm == 1) ? DS3231_A1F : DS3231_A2F;
+
+    if(argc > 3 && strcmp(argv[3], "off") == 0 && (alarm == 1 || alarm == 2))
+        return ds3231_control(0, enable);
+    if((alarm != 1 && alarm != 2) || n != (alarm == 1 ? 3 : 2) || f[0] > 23 || f[1] > 59 ||
+       (alarm == 1 && f[2] > 59)) {
+        printf("Usage: rtc alarm 1 <hh:mm:ss> | 2 <hh:mm> | 1|2 off\r\n");
+        return 1;
+    }
+
+    uint8_t r[4];
+    uint8_t count = 0;
+    if(alarm == 1) r[count++] = ds3231_bcd((uint8_t)f[2]);
+    r[count++] = ds3231_bcd((uint8_t)f[1]);
+    r[count++] = ds3231_bcd((uint8_t)f[0]);
+    r[count++] = DS3231_ALARM_MASK; // any day
+    uint8_t status;
+    int rc = ds3231_write_regs(alarm == 1 ? DS3231_REG_ALARM1 : DS3231_REG_ALARM2, r, count);
+    if(I2C_ERROR_SUCCESS == rc) rc = ds3231_read_reg(DS3231_REG_STATUS, &status);
+    if(I2C_ERROR_SUCCESS == rc) rc = ds3231_write_reg(DS3231_REG_STATUS, status & (uint8_t)~flag);
+    if(I2C_ERROR_SUCCESS == rc) rc = ds3231_control(DS3231_INTCN | enable, 0);
+    rtc_sqw = 0;
+    rtc_trim_on = 0;
+    return rc;
+}
+
+// rtc set <yyyy-mm-dd> <hh:mm:ss>
+static int ds3231_set_command(void)
+{
+    uint16_t d[3], t[3];
+    DS3231_TIME time;
+
+    if(argc < 4 || ds3231_fields(argv[2], d, 3) != 3 || ds3231_fields(argv[3], t, 3) != 3 ||
+       d[0] < 2000 || d[0] > 2199 || d[1] < 1 || d[1] > 12 || d[2] < 1 || d[2] > 31 ||
+       t[0] > 23 || t[1] > 59 || t[2] > 59) {
+        printf("Usage: rtc set <yyyy-mm-dd> <hh:mm:ss>\r\n");
+        return 1;
+    }
+    time.year = d[0];
+    time.month = (uint8_t)d[1];
+    time.mday = (uint8_t)d[2];
+    time.hour = (uint8_t)t[0];
+    time.min = (uint8_t)t[1];
+    time.sec = (uint8_t)t[2];
+    time.wday = ds3231_weekday(time.year, time.month, time.mday);
+    return ds3231_set_time(&time);
+}
+
+// rtc int c|d<pin>
+static int ds3231_int_command(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    char port = (argc > 2) ? (char)(argv[2][0] & ~0x20) : 0; // upper case
+    uint8_t line = (argc > 2) ? (uint8_t)(argv[2][1] - '0') : EDGE_LINES;
+
+    if((port != 'C' && port != 'D') || line >= EDGE_LINES || argv[2][2]) {
+        printf("Usage: rtc int c|d<pin 0-7>\r\n");
+        return 1;
+    }
+    RCC_APB2PeriphClockCmd(port == 'C' ? RCC_APB2Periph_GPIOC : RCC_APB2Periph_GPIOD, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = (uint16_t)(GPIO_Pin_0 << line);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU; // INT/SQW is open drain
+    GPIO_Init(port == 'C' ? GPIOC : GPIOD, &GPIO_InitStructure);
+
+    edge_enable(port, line, EXTI_Trigger_Falling, 0);
+    rtc_port = port;
+    rtc_line = line;
+    rtc_count = 0;
+    rtc_primed = 0;
+    printf("INT/SQW on P%c%u\r\n", port, line);
+    return 0;
+}
+
+// rtc sqw [trim]
+static int ds3231_sqw_command(void)
+{
+    uint8_t trim = (argc > 2 && strcmp(argv[2], "trim") == 0);
+
+    if(argc > 2 && !trim) {
+        printf("Usage: rtc sqw [trim]\r\n");
+        return 1;
+    }
+    if(trim && rtc_line == RTC_NO_LINE) {
+        printf("No INT/SQW pin, rtc int c|d<pin>\r\n");
+        return 1;
+    }
+    if(trim && (RCC->CTLR & RCC_HSEON)) {
+        printf("Running from HSE, nothing to trim\r\n");
+        return 1;
+    }
+    int rc = ds3231_control(0, DS3231_INTCN | DS3231_RS_MASK); // alarms no longer reach INT
+    if(I2C_ERROR_SUCCESS != rc) return rc;
+    rtc_sqw = 1;
+    rtc_primed = 0;
+    rtc_trim_n = 0;
+    rtc_trim_sum = 0;
+    rtc_ppm = 0;
+    rtc_trims = 0;
+    rtc_trim_on = trim;
+    return 0;
+}
+
+// rtc                                  status
+// rtc set <yyyy-mm-dd> <hh:mm:ss>
+// rtc alarm 1 <hh:mm:ss> | 2 <hh:mm> | 1|2 off
+// rtc int c|d<pin>
+// rtc sqw [trim]
+int cl_rtc(void)
+{
+    int rc;
+
+    if(argc > 1 && strcmp(argv[1], "int") == 0)
+        return ds3231_int_command();
+    if(I2C_ERROR_SUCCESS != i2c_device_detect(DS3231_ADDRESS)) {
+        printf("DS3231 Not Found !\r\n");
+        return I2C_ERROR_ACK;
+    }
+    if(argc < 2)
+        rc = ds3231_status_report();
+    else if(strcmp(argv[1], "set") == 0)
+        rc = ds3231_set_command();
+    else if(strcmp(argv[1], "alarm") == 0)
+        rc = ds3231_alarm_command();
+    else if(strcmp(argv[1], "sqw") == 0)
+        rc = ds3231_sqw_command();
+    else {
+        printf("Usage: rtc [set <date> <time> | alarm 1|2 <time>|off | int c|d<pin> | sqw [trim]]\r\n");
+        return 1;
+    }
+    if(rc < 0) printf("I2C error %d\r\n", rc);
+    return rc;
+}
@@ -0,0 +1,57 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ds3231.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : DS3231 real time clock, alarms, INT/SQW, HSI discipline
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_DS3231_H_
+#define USER_DS3231_H_
+
+#include <stdint.h>
+
+#define DS3231_ADDRESS        0x68    // 7-bit I2C address
+
+// Registers
+#define DS3231_REG_TIME       0x00    // seconds .. year, 7 registers, BCD
+#define DS3231_REG_ALARM1     0x07    // seconds, minutes, hours, day/date
+#define DS3231_REG_ALARM2     0x0B    // minutes, hours, day/date
+#define DS3231_REG_CONTROL    0x0E
+#define DS3231_REG_STATUS     0x0F
+#define DS3231_REG_TEMP       0x11    // MSB, LSB bits 7..6, 0.25 C
+
+// Control bits
+#define DS3231_A1IE           0x01
+#define DS3231_A2IE           0x02
+#define DS3231_INTCN          0x04    // 1: alarms drive INT, 0: square wave
+#define DS3231_RS_MASK        0x18    // square wave rate, 00: 1 Hz
+
+// Status bits, flags are cleared by writing 0
+#define DS3231_A1F            0x01
+#define DS3231_A2F            0x02
+#define DS3231_BSY            0x04
+#define DS3231_OSF            0x80    // oscillator stopped, time not valid
+
+#define DS3231_ALARM_MASK     0x80    // AxMn, field not compared
+
+#define RTC_TRIM_SECONDS      8       // 1 Hz periods averaged per trim decision
+#define RTC_TRIM_DEADBAND_PPM 1500    // about 0.6 of an HSITRIM step
+#define RTC_TRIM_GLITCH       50      // reject periods off by more than 1/50
+
+typedef struct {
+    uint8_t  sec, min, hour;  // 24 hour
+    uint8_t  wday;            // 1..7, 1: Sunday
+    uint8_t  mday, month;     // 1..31, 1..12
+    uint16_t year;            // 2000..2199
+} DS3231_TIME;
+
+int  ds3231_read_time(DS3231_TIME * time);
+int  ds3231_set_time(const DS3231_TIME * time);
+int  ds3231_temperature(int16_t * quarters);
+void ds3231_print_temperature(int16_t quarters);
+void ds3231_poll(void);
+
+#endif /* USER_DS3231_H_ */
@@ -0,0 +1,366 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : edge.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : EXTI edge timestamps, pulse counting, rate and intervals
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  edge                                      counts and rates since the last report
+  edge c|d<pin> rise|fall|both [debounce_us] count edges on PC<pin> or PD<pin>
+  edge off <pin>|all
+  edge hist [pin]                           interval histogram, pin selects and clears
+  edge reset
+
+  EXTI7_0_IRQHandler reads SysTick->CNT, the free-running HCLK counter, once
+  and handles every pending edge line with that timestamp.  An edge within
+  the line's debounce time of the last accepted edge is rejected, otherwise
+  the line's count is incremented and (timestamp, line) is written to a
+  single producer, single consumer ring.  The interrupt owns the head index,
+  edge_poll() in the main loop owns the tail, so neither side locks out
+  the other.  Counts are exact; when the ring is full the entry is dropped,
+  counted as an overrun, and the histogram skips the interval it breaks.
+
+  edge_poll() converts intervals of the histogram line to microseconds into
+  power of 2 buckets.  The ring only feeds the histogram, so it is kept
+  short: a burst of more than EDGE_RING edges between two passes of the main
+  loop costs histogram intervals, never counts.  Timestamps wrap every 2^32 HCLK cycles (89s at 48MHz),
+  longer gaps are measured modulo that.
+
+  An EXTI line selects one port, so PC<n> and PD<n> exclude each other.  The
+  pin mode is left as it is, pull-ups are up to the application or board.
+  la.c borrows lines that are not in use here, through edge_exti_hook.
+  Other modules count a line with edge_enable() and follow it with
+  edge_read(), see ds3231.c.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "clock.h"
+#include "edge.h"
+
+#define EDGE_PORT(line)  ((edge_port_d & (1 << (line))) ? 'D' : 'C')
+
+void EXTI7_0_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
+volatile EDGE_HOOK edge_exti_hook;
+
+// Interrupt side
+static volatile uint8_t  edge_enabled;              // EXTI line mask
+static volatile uint32_t edge_count[EDGE_LINES];
+static volatile uint16_t edge_rejected[EDGE_LINES]; // debounced
+static volatile uint32_t edge_last[EDGE_LINES];     // last accepted timestamp
+static uint32_t edge_debounce[EDGE_LINES];          // HCLK cycles
+static volatile uint32_t edge_ring_time[EDGE_RING];
+static volatile uint8_t  edge_ring_line[EDGE_RING];
+static volatile uint8_t  edge_head;                 // written by the interrupt only
+static volatile uint16_t edge_overruns;
+
+// Foreground side
+static volatile uint8_t edge_tail;                  // written by edge_poll() only
+static uint16_t edge_debounce_us[EDGE_LINES];
+static uint8_t  edge_port_d;                        // bit per line, PD<n> when set, else PC<n>
+static uint32_t edge_reported[EDGE_LINES];          // count at the last report
+static uint32_t edge_window_ms;
+static uint8_t  edge_hist_line;
+static uint8_t  edge_hist_primed;                   // edge_hist_time is valid
+static uint16_t edge_hist_overruns;
+static uint32_t edge_hist_time;
+static uint32_t edge_hist_min, edge_hist_max;       // us
+static uint16_t edge_hist[EDGE_BUCKETS];
+
+/*********************************************************************
+ * @fn      EXTI7_0_IRQHandler
+ *
+ * @brief   Timestamp, debounce and count pending edge lines.
+ *
+ * @return  none
+ */
+void EXTI7_0_IRQHandler(void)
+{
+    uint32_t now = SysTick->CNT;
+
+    if(edge_exti_hook) edge_exti_hook();
+
+    uint8_t pending = (uint8_t)(EXTI->INTFR & edge_enabled);
+    EXTI->INTFR = pending;
+    for(uint8_t line = 0; pending; line++, pending >>= 1) {
+        if(!(pending & 1)) continue;
+        if(edge_count[line] && (now - edge_last[line]) < edge_debounce[line]) {
+            edge_rejected[line]++;
+            continue;
+        }
+        edge_last[line] = now;
+        edge_count[line]++;
+
+        uint8_t head = edge_head;
+        if((uint8_t)(head - edge_tail) >= EDGE_RING) {
+            edge_overruns++;
+            continue;
+        }
+        edge_ring_time[head & (EDGE_RING - 1)] = now;
+        edge_ring_line[head & (EDGE_RING - 1)] = line;
+        edge_head = head + 1; // publish after the entry is written
+    }
+}
+
+// EXTI line mask of the lines counted here
+uint8_t edge_lines(void)
+{
+    return edge_enabled;
+}
+
+// Count of a line, and the timestamp (SysTick) of its last accepted edge
+uint32_t edge_read(uint8_t line, uint32_t * time)
+{
+    __disable_irq();
+    uint32_t count = edge_count[line];
+    *time = edge_last[line];
+    __enable_irq();
+    return count;
+}
+
+static uint32_t edge_us(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
+
+static void edge_hist_record(uint32_t us)
+{
+    uint8_t bucket = 0;
+    while(bucket < EDGE_BUCKETS - 1 && (us >> (bucket + 1))) bucket++;
+    edge_hist[bucket]++;
+    if(us < edge_hist_min) edge_hist_min = us;
+    if(us > edge_hist_max) edge_hist_max = us;
+}
+
+static void edge_hist_clear(uint8_t line)
+{
+    edge_hist_line = line;
+    edge_hist_primed = 0;
+    edge_hist_min = 0xFFFFFFFF;
+    edge_hist_max = 0;
+    memset(edge_hist, 0, sizeof(edge_hist));
+}
+
+/*********************************************************************
+ * @fn      edge_poll
+ *
+ * @brief   Drain the timestamp ring into the interval histogram.
+ *          Called from the main loop.
+ *
+ * @return  none
+ */
+void edge_poll(void)
+{
+    // A dropped entry may be of the histogram line, start over after it
+    if(edge_hist_overruns != edge_overruns) {
+        edge_hist_overruns = edge_overruns;
+        edge_hist_primed = 0;
+    }
+    while(edge_tail != edge_head) {
+        uint8_t i = edge_tail & (EDGE_RING - 1);
+        uint32_t time = edge_ring_time[i];
+        uint8_t line = edge_ring_line[i];
+        edge_tail++; // entry copied, the interrupt may reuse it
+
+        if(line != edge_hist_line) continue;
+        if(edge_hist_primed) edge_hist_record(edge_us(time - edge_hist_time));
+        edge_hist_time = time;
+        edge_hist_primed = 1;
+    }
+}
+
+// Debounce time in HCLK cycles follows the system clock
+static void edge_clock_update(void)
+{
+    for(int line = 0; line < EDGE_LINES; line++)
+        edge_debounce[line] = edge_debounce_us[line] * (SystemCoreClock / 1000000);
+}
+
+static void edge_exti_config(uint8_t line, uint32_t trigger, FunctionalState state)
+{
+    EXTI_InitTypeDef EXTI_InitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    if(state == ENABLE) {
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+        GPIO_EXTILineConfig((edge_port_d & (1 << line)) ? GPIO_PortSourceGPIOD : GPIO_PortSourceGPIOC, line);
+    }
+    EXTI_InitStructure.EXTI_Line = EXTI_Line0 << line;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = (EXTITrigger_TypeDef)trigger;
+    EXTI_InitStructure.EXTI_LineCmd = state;
+    EXTI->INTFR = EXTI_Line0 << line;
+    EXTI_Init(&EXTI_InitStructure);
+
+    if(state == ENABLE)
+        edge_enabled |= (uint8_t)(1 << line);
+    else
+        edge_enabled &= (uint8_t)~(1 << line);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI7_0_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = edge_enabled ? ENABLE : DISABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/*********************************************************************
+ * @fn      edge_enable
+ *
+ * @brief   Count edges on PC<line> or PD<line>, restarting its count.
+ *
+ * @param   port - 'C' or 'D'
+ *          line - 0 to EDGE_LINES - 1
+ *          trigger - EXTI_Trigger_Rising, _Falling or _Rising_Falling
+ *          debounce_us - up to EDGE_DEBOUNCE_MAX
+ *
+ * @return  none
+ */
+void edge_enable(char port, uint8_t line, uint32_t trigger, uint16_t debounce_us)
+{
+    edge_exti_config(line, EXTI_Trigger_Rising, DISABLE);
+    if(!edge_enabled) { // first pin gets the histogram
+        edge_hist_clear(line);
+        edge_window_ms = Millis();
+    }
+    if(port == 'D')
+        edge_port_d |= (uint8_t)(1 << line);
+    else
+        edge_port_d &= (uint8_t)~(1 << line);
+    edge_debounce_us[line] = debounce_us;
+    edge_clock_update();
+    clock_register(edge_clock_update);
+    edge_count[line] = 0;
+    edge_rejected[line] = 0;
+    edge_reported[line] = 0;
+    if(line == edge_hist_line) edge_hist_clear(line);
+    edge_exti_config(line, trigger, ENABLE);
+}
+
+static void edge_reset(void)
+{
+    __disable_irq();
+    for(int line = 0; line < EDGE_LINES; line++) {
+        edge_count[line] = 0;
+        edge_rejected[line] = 0;
+        edge_reported[line] = 0;
+    }
+    edge_overruns = 0;
+    edge_hist_overruns = 0;
+    edge_tail = edge_head; // discard queued timestamps
+    __enable_irq();
+    edge_window_ms = Millis();
+    edge_hist_clear(edge_hist_line);
+}
+
+// Counts, and rates since the previous report
+static void edge_report(void)
+{
+    uint32_t ms = Millis() - edge_window_ms;
+
+    if(!edge_enabled) {
+        printf("No edge pins, edge c|d<pin> rise|fall|both [debounce_us]\r\n");
+        return;
+    }
+    edge_poll();
+    printf("pin  debounce      count   rejected  rate (%u ms)\r\n", ms);
+    for(int line = 0; line < EDGE_LINES; line++) {
+        if(!(edge_enabled & (1 << line))) continue;
+        uint32_t count = edge_count[line];
+        uint32_t delta = count - edge_reported[line];
+        uint32_t window = ms;
+        while(delta > 42949) { delta >>= 1; window >>= 1; } // keep delta * 100000 in 32 bits
+        uint32_t centihz = window ? delta * 100000 / window : 0;
+        printf("P%c%u %6u us  %9u  %9u  %u.%02u Hz\r\n", EDGE_PORT(line), line, edge_debounce_us[line], count,
+               edge_rejected[line], centihz / 100, centihz % 100);
+        edge_reported[line] = count;
+    }
+    if(edge_overruns) printf("%u ring overruns\r\n", edge_overruns);
+    edge_window_ms = Millis();
+}
+
+static void edge_hist_report(void)
+{
+    edge_poll();
+    printf("P%c%u intervals", EDGE_PORT(edge_hist_line), edge_hist_line);
+    if(edge_hist_max) printf(", min %u us, max %u us", edge_hist_min, edge_hist_max);
+    printf("\r\n");
+    for(int i = 0; i < EDGE_BUCKETS; i++) {
+        if(!edge_hist[i]) continue;
+        if(i == EDGE_BUCKETS - 1)
+            printf("%8u+        us: %5u\r\n", 1U << i, edge_hist[i]);
+        else
+            printf("%8u-%8u us: %5u\r\n", i ? 1U << i : 0, (2U << i) - 1, edge_hist[i]);
+    }
+}
+
+// edge                                      counts and rates
+// edge c|d<pin> rise|fall|both [debounce_us]
+// edge off <pin>|all
+// edge hist [pin]
+// edge reset
+int cl_edge(void)
+{
+    static const char * const triggers[] = {"rise", "fall", "both"};
+    static const uint32_t trigger_modes[] = {EXTI_Trigger_Rising, EXTI_Trigger_Falling,
+                                             EXTI_Trigger_Rising_Falling};
+
+    if(argc < 2) {
+        edge_report();
+        return 0;
+    }
+    if(strcmp(argv[1], "reset") == 0) {
+        edge_reset();
+        return 0;
+    }
+    if(strcmp(argv[1], "hist") == 0) {
+        if(argc > 2) {
+            uint32_t line = strtoul(argv[2], NULL, 0);
+            if(line >= EDGE_LINES || !(edge_enabled & (1 << line))) {
+                printf("Pin %s is not counted\r\n", argv[2]);
+                return 1;
+            }
+            edge_poll();
+            edge_hist_clear((uint8_t)line);
+            return 0;
+        }
+        edge_hist_report();
+        return 0;
+    }
+    if(strcmp(argv[1], "off") == 0) {
+        uint8_t all = (argc > 2 && strcmp(argv[2], "all") == 0);
+        uint32_t line = (argc > 2) ? strtoul(argv[2], NULL, 0) : EDGE_LINES;
+        if(!all && line >= EDGE_LINES) {
+            printf("Usage: edge off <pin>|all\r\n");
+            return 1;
+        }
+        for(uint8_t l = 0; l < EDGE_LINES; l++)
+            if((all || l == line) && (edge_enabled & (1 << l))) edge_exti_config(l, EXTI_Trigger_Rising, DISABLE);
+        return 0;
+    }
+
+    // edge c|d<pin> rise|fall|both [debounce_us]
+    char port = (char)(argv[1][0] & ~0x20); // upper case
+    uint8_t line = (uint8_t)(argv[1][1] - '0');
+    uint32_t debounce = (argc > 3) ? strtoul(argv[3], NULL, 0) : 0;
+    int t;
+    for(t = 0; t < 3; t++)
+        if(argc > 2 && strcmp(argv[2], triggers[t]) == 0) break;
+    if((port != 'C' && port != 'D') || line >= EDGE_LINES || argv[1][2] || t == 3 ||
+       debounce > EDGE_DEBOUNCE_MAX) {
+        printf("Usage: edge c|d<pin 0-7> rise|fall|both [debounce 0-%u us]\r\n", EDGE_DEBOUNCE_MAX);
+        return 1;
+    }
+
+    edge_enable(port, line, trigger_modes[t], (uint16_t)debounce);
+    printf("P%c%u %s, debounce %u us\r\n", port, line, triggers[t], debounce);
+    return 0;
+}
@@ -0,0 +1,34 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : edge.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : EXTI edge timestamps, pulse counting, rate and intervals
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_EDGE_H_
+#define USER_EDGE_H_
+
+#include <stdint.h>
+
+#define EDGE_LINES        8       // EXTI lines 0..7, PC<n> or PD<n>
+#ifndef EDGE_RING
+#define EDGE_RING         8       // timestamp ring entries, power of 2, 5 bytes of RAM each
+#endif
+#define EDGE_BUCKETS      24      // interval histogram, 2^n us per bucket, 8.4s+ in the last
+#define EDGE_DEBOUNCE_MAX 65535   // us
+
+typedef void (*EDGE_HOOK)(void);
+
+// Called first from EXTI7_0_IRQHandler while set, for an EXTI line that
+// is not an edge line, see la.c
+extern volatile EDGE_HOOK edge_exti_hook;
+
+uint8_t  edge_lines(void);
+void     edge_enable(char port, uint8_t line, uint32_t trigger, uint16_t debounce_us);
+uint32_t edge_read(uint8_t line, uint32_t * time);
+void     edge_poll(void);
+
+#endif /* USER_EDGE_H_ */
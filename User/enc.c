@@ -0,0 +1,385 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : enc.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Quadrature encoder, timer encoder mode, velocity estimate
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  enc start [1|2]   count A/B on TIM1 (PD2, PA1) or TIM2 (PD4, PD3, default)
+  enc stop
+  enc zero
+  enc               position and speed, revolutions and rpm with "set enc_cpr"
+
+  The timer runs in encoder mode TI12, counting every edge of both phases
+  up or down, so edges cost no CPU time.  Inputs have pull-ups and the
+  ENC_FILTER digital filter.  The update interrupt on each 16-bit wrap
+  extends the count to 32 bits; the counter value tells overflow (near 0)
+  from underflow (near 0xFFFF), so a reversal right at the wrap is safe.
+
+  Count changes are time stamped in an interrupt: channels 1 and 2 capture
+  on the rising edges of TI1 and TI2, and the capture interrupt notes the
+  SysTick time and the position.  That is two of the four counts per line,
+  so a moving shaft stamps at least every 3 counts.  The handler disarms
+  itself after ENC_STAMP_LIMIT stamps, and enc_poll() arms it again, so a
+  fast shaft costs a few interrupts per period, not one per edge.
+
+  enc_poll(), from the main loop, estimates speed at most every
+  ENC_PERIOD_MS from the latest stamp.  Speed is counts over the time
+  between two stamps:
+    fast: ENC_MIN_COUNTS or more per period, a count method over the period
+    slow: the window grows until ENC_MIN_COUNTS have passed, or for
+          ENC_MAX_WINDOW_MS, a period method between count changes
+  Both window ends are edge times, to the interrupt latency, however late
+  the main loop polls.  While no stamp arrives, the speed is limited to 3
+  counts over the time since the last one, so a stopping shaft decays to
+  zero instead of holding the last speed.
+
+  TIM1 is shared with the servo and "lat sw", TIM2 with "la" and "lat fast";
+  those refuse to run on the encoder's timer.  The TIM1 and TIM2 interrupt
+  handlers are here, interrupts of the timer the encoder isn't using go to
+  enc_timer_hook (lat.c).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "kvstore.h"
+#include "enc.h"
+
+#define ENC_IT_STAMP    (TIM_IT_CC1 | TIM_IT_CC2)
+#define ENC_STAMP_GAP   3                // most counts between two stamps
+
+void TIM1_UP_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void TIM1_CC_IRQHandler(void) __attribute__((interrupt("machine")));
+void TIM2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
+volatile ENC_HOOK enc_timer_hook;
+
+static TIM_TypeDef * volatile enc_tim;
+static volatile int16_t enc_high;        // upper 16 bits of the position
+
+// Count change stamps, capture interrupt
+static volatile int32_t  enc_stamp_position;
+static volatile uint32_t enc_stamp_time; // SysTick
+static volatile uint8_t  enc_stamps;     // since the last poll
+
+// Velocity task
+static uint32_t enc_task_ms;
+static int32_t  enc_ref_position;        // window start, a count change
+static uint32_t enc_ref_time;            // SysTick
+static int32_t  enc_last_position;
+static uint32_t enc_last_time;           // SysTick, the count last changed
+static int32_t  enc_rate;                // 0.1 counts per second
+
+// 32-bit position, interrupts disabled or in a handler
+static int32_t enc_position_of(TIM_TypeDef * tim)
+{
+    int16_t high = enc_high;
+    uint16_t count = tim->CNT;
+    if(tim->INTFR & TIM_IT_Update) { // wrapped, the interrupt has not run yet
+        count = tim->CNT;
+        high += (count < 0x8000) ? 1 : -1;
+    }
+    return (int32_t)(((uint32_t)(uint16_t)high << 16) | count);
+}
+
+/*********************************************************************
+ * @fn      enc_irq
+ *
+ * @brief   Counter wrapped, extend the position, or an edge was
+ *          captured, stamp it.  Called from the timer's interrupts.
+ *
+ * @param   tim - TIM1 or TIM2
+ *
+ * @return  none
+ */
+void enc_irq(TIM_TypeDef * tim)
+{
+    uint32_t now = SysTick->CNT;
+    uint16_t flags = tim->INTFR & tim->DMAINTENR & (TIM_IT_Update | ENC_IT_STAMP);
+
+    tim->INTFR = (uint16_t)~flags;
+    if(tim != enc_tim) return;
+    if(flags & TIM_IT_Update)
+        enc_high += (tim->CNT < 0x8000) ? 1 : -1;
+    if(flags & ENC_IT_STAMP) {
+        enc_stamp_time = now;
+        enc_stamp_position = enc_position_of(tim);
+        if(++enc_stamps >= ENC_STAMP_LIMIT) tim->DMAINTENR &= (uint16_t)~ENC_IT_STAMP;
+    }
+}
+
+void TIM1_UP_IRQHandler(void)
+{
+    enc_irq(TIM1);
+}
+
+// Counter read first, enc_timer_hook may be measuring entry latency.
+// Standard attribute, "lat sw" runs this one with HPE off.
+void TIM1_CC_IRQHandler(void)
+{
+    uint16_t now = TIM1->CNT;
+    if(enc_timer_hook && enc_tim != TIM1)
+        enc_timer_hook(TIM1, now);
+    else
+        enc_irq(TIM1);
+}
+
+void TIM2_IRQHandler(void)
+{
+    uint16_t now = TIM2->CNT;
+    if(enc_timer_hook && enc_tim != TIM2)
+        enc_timer_hook(TIM2, now);
+    else
+        enc_irq(TIM2);
+}
+
+// Timer in use, NULL when stopped
+TIM_TypeDef * enc_timer(void)
+{
+    return enc_tim;
+}
+
+// 32-bit position, counts (4 per line)
+int32_t enc_position(void)
+{
+    TIM_TypeDef * tim = enc_tim;
+    if(!tim) return 0;
+
+    __disable_irq();
+    int32_t position = enc_position_of(tim);
+    __enable_irq();
+    return position;
+}
+
+// 0.1 counts per second
+int32_t enc_speed(void)
+{
+    return enc_rate;
+}
+
+// counts over cycles as 0.1 counts per second
+static int32_t enc_rate_of(int32_t counts, uint32_t cycles)
+{
+    uint32_t magnitude = (uint32_t)(counts < 0 ? -counts : counts);
+    uint32_t us = cycles / (SystemCoreClock / 1000000);
+
+    if(!us) return 0;
+    while(magnitude > 214) { magnitude >>= 1; us >>= 1; } // keep magnitude * 1e7 in 32 bits
+    if(!us) us = 1;
+    int32_t rate = (int32_t)(magnitude * 10000000 / us);
+    return counts < 0 ? -rate : rate;
+}
+
+static void enc_window_start(int32_t position, uint32_t time)
+{
+    enc_ref_position = position;
+    enc_ref_time = time;
+    enc_last_position = position;
+    enc_last_time = time;
+}
+
+/*********************************************************************
+ * @fn      enc_poll
+ *
+ * @brief   Velocity task, see the note above.  Called from the main loop.
+ *
+ * @return  none
+ */
+void enc_poll(void)
+{
+    TIM_TypeDef * tim = enc_tim;
+    if(!tim || Millis() - enc_task_ms < ENC_PERIOD_MS) return;
+    enc_task_ms = Millis();
+
+    __disable_irq();
+    uint32_t now = SysTick->CNT;
+    int32_t position = enc_position_of(tim);
+    uint8_t stamps = enc_stamps;
+    if(stamps) {
+        enc_last_position = enc_stamp_position;
+        enc_last_time = enc_stamp_time;
+    }
+    enc_stamps = 0;
+    if(!(tim->DMAINTENR & TIM_IT_CC1)) { // disarmed, flags are old edges
+        tim->INTFR = (uint16_t)~ENC_IT_STAMP;
+        tim->DMAINTENR |= ENC_IT_STAMP;
+    }
+    __enable_irq();
+
+    int32_t counts = enc_last_position - enc_ref_position;
+    uint32_t window = enc_last_time - enc_ref_time;
+    uint32_t max_window = ENC_MAX_WINDOW_MS * (SystemCoreClock / 1000);
+
+    if(counts >= ENC_MIN_COUNTS || counts <= -ENC_MIN_COUNTS) {
+        enc_rate = enc_rate_of(counts, window);
+        enc_window_start(enc_last_position, enc_last_time);
+    }
+    else if(now - enc_ref_time >= max_window) {
+        enc_rate = counts ? enc_rate_of(counts, window) : 0;
+        if(counts)
+            enc_window_start(enc_last_position, enc_last_time);
+        else
+            enc_window_start(position, now);
+    }
+    else if(stamps < ENC_STAMP_LIMIT && now != enc_last_time) {
+        // No more than ENC_STAMP_GAP counts since the last stamp
+        int32_t bound = enc_rate_of(ENC_STAMP_GAP, now - enc_last_time);
+        if(enc_rate > bound) enc_rate = bound;
+        if(enc_rate < -bound) enc_rate = -bound;
+    }
+}
+
+static void enc_gpio_config(GPIO_TypeDef * port, uint16_t pins)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+
+    GPIO_InitStructure.GPIO_Pin = pins;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(port, &GPIO_InitStructure);
+}
+
+static void enc_irq_config(IRQn_Type irq, FunctionalState state)
+{
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+    NVIC_InitStructure.NVIC_IRQChannel = irq;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = state;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+static void enc_stop(void)
+{
+    TIM_TypeDef * tim = enc_tim;
+    if(!tim) return;
+    TIM_Cmd(tim, DISABLE);
+    TIM_ITConfig(tim, TIM_IT_Update | ENC_IT_STAMP, DISABLE);
+    enc_irq_config(tim == TIM1 ? TIM1_UP_IRQn : TIM2_IRQn, DISABLE);
+    if(tim == TIM1) enc_irq_config(TIM1_CC_IRQn, DISABLE);
+    enc_tim = NULL;
+    enc_rate = 0;
+}
+
+// Encoder mode on TIM1 (PD2, PA1) or TIM2 (PD4, PD3)
+static void enc_start(TIM_TypeDef * tim)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
+
+    enc_stop();
+    if(tim == TIM1) {
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOD | RCC_APB2Periph_TIM1, ENABLE);
+        enc_gpio_config(GPIOD, GPIO_Pin_2);
+        enc_gpio_config(GPIOA, GPIO_Pin_1);
+    }
+    else {
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD, ENABLE);
+        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+        enc_gpio_config(GPIOD, GPIO_Pin_4 | GPIO_Pin_3);
+    }
+
+    TIM_DeInit(tim);
+    TIM_TimeBaseInitStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseInitStructure.TIM_Prescaler = 0;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(tim, &TIM_TimeBaseInitStructure);
+    TIM_EncoderInterfaceConfig(tim, TIM_EncoderMode_TI12, TIM_ICPolarity_Rising, TIM_ICPolarity_Rising);
+    tim->CHCTLR1 |= (ENC_FILTER << 4) | (ENC_FILTER << 12); // IC1F, IC2F
+    tim->CCER |= TIM_CC1E | TIM_CC2E; // capture rising edges, the stamps
+    tim->CNT = 0;
+    tim->INTFR = 0;
+
+    enc_high = 0;
+    enc_rate = 0;
+    enc_task_ms = Millis();
+    enc_window_start(0, SysTick->CNT);
+    enc_stamps = 0;
+    enc_tim = tim;
+    TIM_ITConfig(tim, TIM_IT_Update | ENC_IT_STAMP, ENABLE);
+    enc_irq_config(tim == TIM1 ? TIM1_UP_IRQn : TIM2_IRQn, ENABLE);
+    if(tim == TIM1) enc_irq_config(TIM1_CC_IRQn, ENABLE);
+    TIM_Cmd(tim, ENABLE);
+}
+
+// value * scale / cpr without 64-bit arithmetic
+static int32_t enc_per_rev(int32_t value, int32_t scale, int32_t cpr)
+{
+    return (value / cpr) * scale + (value % cpr) * scale / cpr;
+}
+
+// Signed tenths as "-12.3"
+static void enc_print_tenths(int32_t tenths)
+{
+    uint32_t magnitude = (uint32_t)(tenths < 0 ? -tenths : tenths);
+    printf("%s%u.%u", tenths < 0 ? "-" : "", magnitude / 10, magnitude % 10);
+}
+
+// enc start [1|2]
+// enc stop
+// enc zero
+// enc
+int cl_enc(void)
+{
+    if(argc > 1 && strcmp(argv[1], "start") == 0) {
+        uint32_t timer = (argc > 2) ? strtoul(argv[2], NULL, 0) : 2;
+        if(timer != 1 && timer != 2) {
+            printf("Usage: enc start [1|2]\r\n");
+            return 1;
+        }
+        enc_start(timer == 1 ? TIM1 : TIM2);
+        printf("TIM%u, A %s, B %s\r\n", timer, timer == 1 ? "PD2" : "PD4", timer == 1 ? "PA1" : "PD3");
+        return 0;
+    }
+    if(argc > 1 && strcmp(argv[1], "stop") == 0) {
+        enc_stop();
+        return 0;
+    }
+    if(!enc_tim) {
+        printf("Encoder stopped, enc start [1|2]\r\n");
+        return 1;
+    }
+    if(argc > 1 && strcmp(argv[1], "zero") == 0) {
+        __disable_irq();
+        enc_tim->CNT = 0;
+        enc_tim->INTFR = (uint16_t)~TIM_IT_Update;
+        enc_high = 0;
+        enc_stamps = 0;
+        __enable_irq();
+        enc_window_start(0, SysTick->CNT);
+        return 0;
+    }
+    if(argc > 1) {
+        printf("Usage: enc [start [1|2] | stop | zero]\r\n");
+        return 1;
+    }
+
+    enc_poll();
+    int32_t position = enc_position();
+    int32_t rate = enc_rate;
+    uint32_t cpr = kv_get(KV_KEY_ENC_CPR, 0);
+
+    printf("Position %d", position);
+    if(cpr) {
+        printf(", ");
+        enc_print_tenths(enc_per_rev(position, 10, (int32_t)cpr));
+        printf(" rev");
+    }
+    printf(", speed ");
+    enc_print_tenths(rate);
+    printf(" counts/s");
+    if(cpr) {
+        printf(", ");
+        enc_print_tenths(enc_per_rev(rate, 60, (int32_t)cpr));
+        printf(" rpm");
+    }
+    printf("\r\n");
+    return 0;
+}
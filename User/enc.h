@@ -0,0 +1,33 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : enc.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Quadrature encoder, timer encoder mode, velocity estimate
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_ENC_H_
+#define USER_ENC_H_
+
+#include "ch32v00x.h"
+
+#define ENC_FILTER         6       // IC1F/IC2F, 6 samples at HCLK / 4, 0.5us at 48MHz
+#define ENC_PERIOD_MS      20      // velocity task, at most this often
+#define ENC_MIN_COUNTS     8       // counts per estimate, fewer extends the window
+#define ENC_MAX_WINDOW_MS  2000    // longest window, slower reads as zero
+#define ENC_STAMP_LIMIT    8       // capture interrupts per period, then off until the poll
+
+// Interrupt of a TIM1/TIM2 the encoder isn't using, counter read on entry
+typedef void (*ENC_HOOK)(TIM_TypeDef * tim, uint16_t count);
+
+TIM_TypeDef * enc_timer(void);     // timer in use, NULL when stopped
+int32_t enc_position(void);
+int32_t enc_speed(void);           // 0.1 counts per second
+void    enc_irq(TIM_TypeDef * tim);
+void    enc_poll(void);
+
+extern volatile ENC_HOOK enc_timer_hook;
+
+#endif /* USER_ENC_H_ */
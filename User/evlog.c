@@ -0,0 +1,163 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : evlog.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Persistent binary event log, internal flash ring
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Events are 8 byte records: timestamp, ID, boot counter, payload.
+  Records collect in a RAM page image, which is written to the next of
+  IFLASH_LOG_PAGES flash pages when full, on evlog_flush(), or before a
+  software reset.  Pages are reused round-robin, the oldest page is
+  overwritten, so the log always holds the most recent events.
+  Events still in RAM are lost on an unexpected reset.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "crc16.h"
+#include "iflash.h"
+#include "evlog.h"
+#include "wdog.h"
+
+static EVLOG_PAGE evlog_image;     // page being filled
+static uint8_t evlog_count;        // records in evlog_image
+static uint8_t evlog_write_page;   // next flash page to write
+static uint32_t evlog_seq;         // sequence number of newest page
+static uint8_t evlog_boot;
+
+static const char * const evlog_names[EVLOG_COUNT] = {
+    "none",
+    "boot",
+    "i2c error",
+    "watchdog",
+    "stack",
+    "crash",
+};
+
+static const EVLOG_PAGE * evlog_flash_page(uint8_t page)
+{
+    return (const EVLOG_PAGE *)(IFLASH_LOG_BASE + (uint32_t)page * IFLASH_PAGE_SIZE);
+}
+
+static uint16_t evlog_page_crc(const EVLOG_PAGE * p)
+{
+    uint16_t crc = crc16(CRC16_INIT, p, 6); // seq, magic
+    return crc16(crc, p->rec, sizeof(p->rec));
+}
+
+static int evlog_page_valid(const EVLOG_PAGE * p)
+{
+    return p->magic == EVLOG_MAGIC && p->crc == evlog_page_crc(p);
+}
+
+/*********************************************************************
+ * @fn      evlog_init
+ *
+ * @brief   Locate newest page, advance boot counter, log reset cause.
+ *          Call once at boot, after Delay_Init().
+ *
+ * @return  none
+ */
+void evlog_init(void)
+{
+    int newest = -1;
+
+    for(int i = 0; i < IFLASH_LOG_PAGES; i++) {
+        const EVLOG_PAGE * p = evlog_flash_page(i);
+        if(evlog_page_valid(p) && (newest < 0 || (int32_t)(p->seq - evlog_seq) > 0)) {
+            newest = i;
+            evlog_seq = p->seq;
+        }
+    }
+    if(newest >= 0) {
+        const EVLOG_PAGE * p = evlog_flash_page(newest);
+        for(int r = 0; r < EVLOG_PAGE_RECORDS && p->rec[r].id != EVLOG_NONE; r++)
+            evlog_boot = p->rec[r].boot + 1;
+        evlog_write_page = (uint8_t)((newest + 1) % IFLASH_LOG_PAGES);
+    }
+
+    uint32_t flags = RCC->RSTSCKR;
+    evlog_event(EVLOG_BOOT, (uint16_t)(flags >> 24));
+    if(flags & (RCC_IWDGRSTF | RCC_WWDGRSTF)) {
+        evlog_event(EVLOG_WATCHDOG, (flags & RCC_IWDGRSTF) ? 1 : 2);
+        evlog_flush(); // don't lose evidence to a reset loop
+    }
+}
+
+// Add event to RAM page, writing the page to flash when full
+void evlog_event(EVLOG_ID id, uint16_t data)
+{
+    EVLOG_RECORD * rec = &evlog_image.rec[evlog_count];
+    rec->ms = Millis();
+    rec->id = (uint8_t)id;
+    rec->boot = evlog_boot;
+    rec->data = data;
+    if(++evlog_count >= EVLOG_PAGE_RECORDS)
+        evlog_flush();
+}
+
+// Write pending records to the next flash page
+void evlog_flush(void)
+{
+    if(!evlog_count) return;
+
+    // Unused records remain zero (EVLOG_NONE)
+    evlog_image.seq = ++evlog_seq;
+    evlog_image.magic = EVLOG_MAGIC;
+    evlog_image.crc = evlog_page_crc(&evlog_image);
+    iflash_write_page(IFLASH_LOG_BASE + (uint32_t)evlog_write_page * IFLASH_PAGE_SIZE, (const uint32_t *)&evlog_image);
+
+    evlog_write_page = (uint8_t)((evlog_write_page + 1) % IFLASH_LOG_PAGES);
+    memset(&evlog_image, 0, sizeof(evlog_image));
+    evlog_count = 0;
+}
+
+static void evlog_print(const EVLOG_RECORD * rec)
+{
+    const char * name = (rec->id < EVLOG_COUNT) ? evlog_names[rec->id] : "?";
+    printf("%3u %7u.%03u  %-10s %04X", rec->boot, rec->ms / 1000, rec->ms % 1000, name, rec->data);
+    if(rec->id == EVLOG_BOOT) {
+        // Reset flags, RCC->RSTSCKR bits 31..26
+        if(rec->data & (RCC_LPWRRSTF >> 24)) printf(" LPWR");
+        if(rec->data & (RCC_WWDGRSTF >> 24)) printf(" WWDG");
+        if(rec->data & (RCC_IWDGRSTF >> 24)) printf(" IWDG");
+        if(rec->data & (RCC_SFTRSTF >> 24))  printf(" SFT");
+        if(rec->data & (RCC_PORRSTF >> 24))  printf(" POR");
+        if(rec->data & (RCC_PINRSTF >> 24))  printf(" PIN");
+    } else if(rec->id == EVLOG_I2C_ERROR) {
+        printf(" addr %02X, error %d", rec->data >> 8, -(int)(rec->data & 0xFF));
+    } else if(rec->id == EVLOG_CRASH) {
+        printf(" %s, mcause %u", (rec->data >> 8) == WDOG_CRASH_WWDG ? "WWDG stall" : "fault", rec->data & 0xFF);
+    }
+    printf("\r\n");
+}
+
+// log        -- dump and decode log, oldest first
+// log flush  -- write pending RAM records to flash
+int cl_log(void)
+{
+    if(argc > 1 && strcmp(argv[1], "flush") == 0) {
+        evlog_flush();
+        return 0;
+    }
+
+    printf("Boot   Time(s)    Event      Data\r\n");
+    for(int n = 0; n < IFLASH_LOG_PAGES; n++) {
+        const EVLOG_PAGE * p = evlog_flash_page((uint8_t)((evlog_write_page + n) % IFLASH_LOG_PAGES));
+        if(!evlog_page_valid(p)) continue;
+        for(int r = 0; r < EVLOG_PAGE_RECORDS && p->rec[r].id != EVLOG_NONE; r++)
+            evlog_print(&p->rec[r]);
+    }
+    for(int r = 0; r < evlog_count; r++)
+        evlog_print(&evlog_image.rec[r]);
+    printf("%u record(s) pending in RAM\r\n", evlog_count);
+    return 0;
+}
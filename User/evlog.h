@@ -0,0 +1,49 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : evlog.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Persistent binary event log, internal flash ring
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_EVLOG_H_
+#define USER_EVLOG_H_
+
+#include <stdint.h>
+
+// Event IDs, stored in flash, never renumber
+typedef enum {
+    EVLOG_NONE = 0,
+    EVLOG_BOOT,         // data: RCC->RSTSCKR reset flags >> 24
+    EVLOG_I2C_ERROR,    // data: address << 8 | -(I2C_ERROR)
+    EVLOG_WATCHDOG,     // data: 1: IWDG reset, 2: WWDG reset
+    EVLOG_STACK,        // data: stack high-water mark, bytes
+    EVLOG_CRASH,        // data: WDOG_CRASH_SOURCE << 8 | mcause low 8 bits, see "crash"
+    EVLOG_COUNT
+} EVLOG_ID;
+
+#define EVLOG_MAGIC         0x4C47  // "LG"
+#define EVLOG_PAGE_RECORDS  7
+
+typedef struct {
+    uint32_t ms;        // Millis() timestamp
+    uint8_t  id;        // EVLOG_ID
+    uint8_t  boot;      // boot counter, low 8 bits
+    uint16_t data;      // event specific payload
+} EVLOG_RECORD;
+
+// One 64 byte flash page
+typedef struct {
+    uint32_t seq;
+    uint16_t magic;
+    uint16_t crc;       // CRC16 of page, with crc field zero
+    EVLOG_RECORD rec[EVLOG_PAGE_RECORDS];
+} EVLOG_PAGE;
+
+void evlog_init(void);
+void evlog_event(EVLOG_ID id, uint16_t data);
+void evlog_flush(void);
+
+#endif /* USER_EVLOG_H_ */
@@ -6,6 +6,15 @@
  */
 #include "debug.h"
 #include "i2c.h"
+#include "evlog.h"
+#include "clock.h"
+
+static u32 i2c_speed;
+static u16 i2c_own_address;
+static uint32_t i2c_error_ms[3];    // Millis() of the last record, per -(I2C_ERROR) - 1
+static uint8_t  i2c_error_logged;   // bit per error code, i2c_error_ms is valid
+
+static void i2c_clock_update(void);
 
 /*********************************************************************
  * @fn      IIC_Init
@@ -44,6 +53,16 @@ void IIC_Init(u32 bound, u16 address)
 
     I2C_Cmd( I2C1, ENABLE );
 
+    i2c_speed = bound;
+    i2c_own_address = address;
+    clock_register(i2c_clock_update);
+}
+
+// Clock change callback, I2C_Init() derives CCR and FREQ from the new PCLK
+static void i2c_clock_update(void)
+{
+    I2C_Cmd(I2C1, DISABLE);
+    IIC_Init(i2c_speed, i2c_own_address);
 }
 
 // Spin, waiting for I2C module to become Not Busy (Both SCL and SDA are high)
@@ -154,29 +173,45 @@ int i2c_read_byte(uint8_t * data)
     return I2C_ERROR_SUCCESS;
 }
 
+// Record a failed transfer in the event log, return the error code.
+// A flapping bus or a polling caller would cycle the flash ring, so each
+// error code is logged at most once per I2C_ERROR_LOG_MS.
+static int i2c_error(uint16_t i2c_address, int rc)
+{
+    uint8_t code = (uint8_t)(-rc - 1);
+    uint32_t now = Millis();
+
+    if(code >= sizeof(i2c_error_ms) / sizeof(i2c_error_ms[0])) return rc;
+    if((i2c_error_logged & (1 << code)) && now - i2c_error_ms[code] < I2C_ERROR_LOG_MS) return rc;
+    i2c_error_logged |= (uint8_t)(1 << code);
+    i2c_error_ms[code] = now;
+    evlog_event(EVLOG_I2C_ERROR, (uint16_t)((i2c_address << 8) | (uint8_t)(-rc)));
+    return rc;
+}
+
 // Given 7-bit address, pointer to data, and count, send data to I2C peripheral
 // Returns I2C_ERROR code
 int i2c_write(uint16_t i2c_address, uint8_t * data, uint8_t count)
 {
     //printf("Wait for Not Busy\n");
     I2C_ERROR rc = i2c_wait_not_busy();
-    if(I2C_ERROR_SUCCESS != rc) return rc;
+    if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
 
     //printf("Start\n");
     I2C_GenerateSTART( I2C1, ENABLE );
 
     //printf("Wait for master mode\r\n");
     rc = i2c_wait_master_mode();
-    if(I2C_ERROR_SUCCESS != rc) return rc;
+    if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
 
     //printf("Send Address\n");
     rc = i2c_send_byte(i2c_address<<1); // R/W bit clear
-    if(I2C_ERROR_SUCCESS != rc) return rc;
+    if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
 
     // Send data bytes
     while(count) {
         rc = i2c_send_byte(*data);
-        if(I2C_ERROR_SUCCESS != rc) return rc;
+        if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
         data++;
         count--;
     } // while
@@ -196,25 +231,25 @@ int i2c_read(uint16_t i2c_address, uint8_t * data, uint8_t count)
     I2C1->CTLR1 |= (1<<10); // Set ACK bit
     //printf("Wait for Not Busy\n");
     I2C_ERROR rc = i2c_wait_not_busy();
-    if(I2C_ERROR_SUCCESS != rc) return rc;
+    if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
 
     //printf("Start\n");
     I2C_GenerateSTART( I2C1, ENABLE );
 
     //printf("Wait for master mode\r\n");
     rc = i2c_wait_master_mode();
-    if(I2C_ERROR_SUCCESS != rc) return rc;
+    if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
 
     //printf("Send Address\n");
     rc = i2c_send_byte((i2c_address<<1) | 1); // R/W bit set
-    if(I2C_ERROR_SUCCESS != rc) return rc;
+    if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
 
     // Read data bytes
     while(count) {
         // If this is the last byte, NAK it
         if(count == 1) I2C1->CTLR1 &= ~(1<<10); // Clear ACK bit before data is read from DATAR
         rc = i2c_read_byte(data);
-        if(I2C_ERROR_SUCCESS != rc) return rc;
+        if(I2C_ERROR_SUCCESS != rc) return i2c_error(i2c_address, rc);
         data++;
         count--;
     } // while
@@ -25,6 +25,8 @@ typedef enum {
 #define I2C_TRANSMIT_EMPTY_LOOPS        10000
 #define I2C_MASTER_RECEIVER_LOOPS       10000
 
+#define I2C_ERROR_LOG_MS                10000   // event log, at most one record per error code per period
+
 
 void IIC_Init(u32 bound, u16 address);
 int i2c_write(uint16_t i2c_address, uint8_t * data, uint8_t count);
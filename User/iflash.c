@@ -0,0 +1,38 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : iflash.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Internal flash, 64 byte fast page erase/program
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#include "debug.h"
+#include "iflash.h"
+#include "prof.h"
+
+/*********************************************************************
+ * @fn      iflash_write_page
+ *
+ * @brief   Erase and program one 64 byte page using the fast page API.
+ *          The CPU stalls while flash is busy.
+ *
+ * @param   address - page address, 64 byte aligned, 0x08000000 alias
+ *          data - 16 words to program
+ *
+ * @return  none
+ */
+void iflash_write_page(uint32_t address, const uint32_t * data)
+{
+    PROF_BEGIN(PROF_IFLASH_WRITE);
+    FLASH_Unlock_Fast();
+    FLASH_ErasePage_Fast(address);
+    FLASH_BufReset();
+    for(int i = 0; i < IFLASH_PAGE_WORDS; i++)
+        FLASH_BufLoad(address + i * 4, data[i]);
+    FLASH_ProgramPage_Fast(address);
+    FLASH_Lock_Fast();
+    FLASH_Lock();
+    PROF_END(PROF_IFLASH_WRITE);
+}
@@ -0,0 +1,30 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : iflash.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Internal flash, 64 byte fast page erase/program
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_IFLASH_H_
+#define USER_IFLASH_H_
+
+#include <stdint.h>
+
+#define IFLASH_PAGE_SIZE   64
+#define IFLASH_PAGE_WORDS  (IFLASH_PAGE_SIZE / 4)
+
+// Internal flash layout, 16K total, see Ld/Link.ld
+// 0x08000000 - 0x08003BFF : firmware (FLASH region)
+// 0x08003C00 - 0x08003DFF : event log, 8 pages
+// 0x08003E00 - 0x08003FFF : key/value store, 8 pages
+#define IFLASH_LOG_BASE    0x08003C00
+#define IFLASH_LOG_PAGES   8
+#define IFLASH_KV_BASE     0x08003E00
+#define IFLASH_KV_PAGES    8
+
+void iflash_write_page(uint32_t address, const uint32_t * data);
+
+#endif /* USER_IFLASH_H_ */
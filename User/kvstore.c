@@ -0,0 +1,249 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : kvstore.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Wear-leveled key/value configuration store, internal flash
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Log structured store in the last IFLASH_KV_PAGES pages of flash.
+  Pages are written round-robin, each holding up to 7 key/value records plus a
+  sequence number and CRC.  kv_save() appends only changed keys, so flash wear
+  spreads evenly across the pages.
+
+  At boot, kv_init() finds the newest valid page and replays pages from oldest
+  to newest into a RAM table indexed by key, so lookups are O(1).
+
+  Garbage collection: before a page is written, any key whose latest record
+  lives in the page after it (the next page to be erased) is carried forward.
+  The page being erased therefore never holds the only copy of a value.
+
+  Each key has a valid range, kv_ranges.  "set" refuses values outside it,
+  kv_get() returns the caller's default for a stored value outside it, so
+  a bad setting can't stop the console or the I2C bus at the next boot.
+
+  kv_save() builds each page in the shared scratch buffer (scratch.h), so
+  call it from a command, never from an interrupt or a poll task.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "crc16.h"
+#include "iflash.h"
+#include "kvstore.h"
+#include "wdog.h"
+#include "scratch.h"
+
+#define KV_NO_PAGE  0xFF
+
+#if IFLASH_PAGE_SIZE > SCRATCH_SIZE
+#error "IFLASH_PAGE_SIZE: the page image must fit the scratch buffer"
+#endif
+
+static uint32_t kv_value[KV_KEY_COUNT];
+static uint8_t  kv_page[KV_KEY_COUNT];  // page holding latest record, KV_NO_PAGE if none
+static uint16_t kv_dirty;               // bit per key, changed since last save
+static uint8_t  kv_write_page;          // next page to write
+static uint32_t kv_seq;                 // sequence number of newest page
+
+static const char * const kv_names[KV_KEY_COUNT] = {
+    "i2c_speed",
+    "baud",
+    "pwm_min",
+    "pwm_max",
+    "enc_cpr",
+    "wdog",
+};
+
+typedef struct {
+    uint32_t min, max;
+} KV_RANGE;
+
+static const KV_RANGE kv_ranges[KV_KEY_COUNT] = {
+    {10000, 400000},        // i2c_speed, Hz
+    {1200, 3000000},        // baud, USART BRR at 48 MHz
+    {500, 2500},            // pwm_min, us
+    {500, 2500},            // pwm_max, us
+    {0, 1000000},           // enc_cpr
+    {0, WDOG_MAX_MS},       // wdog, wdog_init() raises 1 .. WDOG_MIN_MS
+};
+
+static int kv_in_range(KV_KEY key, uint32_t value)
+{
+    return value >= kv_ranges[key].min && value <= kv_ranges[key].max;
+}
+
+static const KV_PAGE * kv_flash_page(uint8_t page)
+{
+    return (const KV_PAGE *)(IFLASH_KV_BASE + (uint32_t)page * IFLASH_PAGE_SIZE);
+}
+
+static uint16_t kv_page_crc(const KV_PAGE * p)
+{
+    uint16_t crc = crc16(CRC16_INIT, p, 6); // seq, magic
+    return crc16(crc, p->rec, sizeof(p->rec));
+}
+
+static int kv_page_valid(const KV_PAGE * p)
+{
+    return p->magic == KV_MAGIC && p->crc == kv_page_crc(p);
+}
+
+/*********************************************************************
+ * @fn      kv_init
+ *
+ * @brief   Rebuild RAM index from flash.  Call once at boot.
+ *
+ * @return  none
+ */
+void kv_init(void)
+{
+    int newest = -1;
+
+    memset(kv_page, KV_NO_PAGE, sizeof(kv_page));
+    kv_dirty = 0;
+    kv_seq = 0;
+
+    // Find the newest valid page
+    for(int i = 0; i < IFLASH_KV_PAGES; i++) {
+        const KV_PAGE * p = kv_flash_page(i);
+        if(kv_page_valid(p) && (newest < 0 || (int32_t)(p->seq - kv_seq) > 0)) {
+            newest = i;
+            kv_seq = p->seq;
+        }
+    }
+    if(newest < 0) {
+        kv_write_page = 0;
+        return; // empty store
+    }
+
+    // Replay from oldest (page after newest) to newest, later records win
+    for(int n = 1; n <= IFLASH_KV_PAGES; n++) {
+        uint8_t page = (uint8_t)((newest + n) % IFLASH_KV_PAGES);
+        const KV_PAGE * p = kv_flash_page(page);
+        if(!kv_page_valid(p) || (int32_t)(kv_seq - p->seq) >= IFLASH_KV_PAGES) continue; // stale
+        for(int r = 0; r < KV_PAGE_RECORDS; r++) {
+            uint16_t key = p->rec[r].key;
+            if(key == 0 || key > KV_KEY_COUNT) continue;
+            kv_value[key - 1] = p->rec[r].value;
+            kv_page[key - 1] = page;
+        }
+    }
+    kv_write_page = (uint8_t)((newest + 1) % IFLASH_KV_PAGES);
+}
+
+// Return value for key, or def if never set or out of range
+uint32_t kv_get(KV_KEY key, uint32_t def)
+{
+    if(key >= KV_KEY_COUNT) return def;
+    if(kv_page[key] == KV_NO_PAGE && !(kv_dirty & (1 << key))) return def;
+    if(!kv_in_range(key, kv_value[key])) return def;
+    return kv_value[key];
+}
+
+// Change value in RAM, see kv_save() to make it persistent
+void kv_set(KV_KEY key, uint32_t value)
+{
+    if(key >= KV_KEY_COUNT) return;
+    if(kv_value[key] == value && kv_page[key] != KV_NO_PAGE) return; // unchanged
+    kv_value[key] = value;
+    kv_dirty |= (1 << key);
+}
+
+/*********************************************************************
+ * @fn      kv_save
+ *
+ * @brief   Append changed keys to flash, one page at a time.  Takes
+ *          the scratch buffer for the page image.
+ *
+ * @return  number of pages written
+ */
+int kv_save(void)
+{
+    KV_PAGE * image = scratch_take(SCRATCH_KV);    // page being built
+    int pages = 0;
+
+    while(kv_dirty) {
+        uint8_t page = kv_write_page;
+        uint8_t next = (uint8_t)((page + 1) % IFLASH_KV_PAGES);
+
+        // Carry forward keys that only live in this page or the next page to be erased
+        for(int k = 0; k < KV_KEY_COUNT; k++)
+            if(kv_page[k] == page || kv_page[k] == next) kv_dirty |= (1 << k);
+
+        memset(image, 0, sizeof(*image));
+        image->seq = kv_seq + 1;
+        image->magic = KV_MAGIC;
+        int r = 0;
+        for(int k = 0; k < KV_KEY_COUNT && r < KV_PAGE_RECORDS; k++) {
+            if(!(kv_dirty & (1 << k))) continue;
+            image->rec[r].key = (uint16_t)(k + 1);
+            image->rec[r].value = kv_value[k];
+            kv_dirty &= ~(1 << k);
+            kv_page[k] = page;
+            r++;
+        }
+        image->crc = kv_page_crc(image);
+
+        iflash_write_page(IFLASH_KV_BASE + (uint32_t)page * IFLASH_PAGE_SIZE, (const uint32_t *)image);
+        kv_seq++;
+        kv_write_page = next;
+        pages++;
+    }
+    return pages;
+}
+
+// Look up key by name, return KV_KEY_COUNT if not found
+static KV_KEY kv_lookup(const char * name)
+{
+    int k;
+    for(k = 0; k < KV_KEY_COUNT; k++)
+        if(strcmp(name, kv_names[k]) == 0) break;
+    return (KV_KEY)k;
+}
+
+// set <name> <value>
+int cl_set(void)
+{
+    KV_KEY key = kv_lookup(argv[1]);
+    if(key == KV_KEY_COUNT) {
+        printf("Unknown key: %s\r\n", argv[1]);
+        return 1;
+    }
+    char * end;
+    uint32_t value = strtoul(argv[2], &end, 0);
+    if(*end || !kv_in_range(key, value)) {
+        printf("%s: %u to %u\r\n", kv_names[key], kv_ranges[key].min, kv_ranges[key].max);
+        return 1;
+    }
+    kv_set(key, value);
+    return 0;
+}
+
+// get [name], no name displays all keys
+int cl_get(void)
+{
+    for(int k = 0; k < KV_KEY_COUNT; k++) {
+        if(argc > 1 && strcmp(argv[1], kv_names[k])) continue;
+        printf("%-10s ", kv_names[k]);
+        if(kv_page[k] == KV_NO_PAGE && !(kv_dirty & (1 << k)))
+            printf("(not set)\r\n");
+        else
+            printf("%u%s\r\n", kv_value[k], (kv_dirty & (1 << k)) ? " *" : "");
+    }
+    return 0;
+}
+
+// save changed keys to flash
+int cl_save(void)
+{
+    int pages = kv_save();
+    printf("Wrote %d page(s), seq %u, next page %u\r\n", pages, kv_seq, kv_write_page);
+    return 0;
+}
@@ -0,0 +1,50 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : kvstore.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Wear-leveled key/value configuration store, internal flash
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_KVSTORE_H_
+#define USER_KVSTORE_H_
+
+#include <stdint.h>
+
+// Keys, index into RAM table.  Append new keys before KV_KEY_COUNT,
+// never renumber, numbers are stored in flash.
+typedef enum {
+    KV_KEY_I2C_SPEED = 0,   // IIC_Init() bus speed, Hz
+    KV_KEY_BAUD,            // USART_Printf_Init2() baud rate
+    KV_KEY_PWM_MIN,         // servo pulse width minimum, us
+    KV_KEY_PWM_MAX,         // servo pulse width maximum, us
+    KV_KEY_ENC_CPR,         // encoder counts per revolution (4 x lines), 0: counts only
+    KV_KEY_WDOG,            // watchdog period, ms, 0: off
+    KV_KEY_COUNT
+} KV_KEY;
+
+#define KV_MAGIC            0x4B56  // "KV"
+#define KV_PAGE_RECORDS     7
+
+typedef struct {
+    uint16_t key;     // KV_KEY + 1, 0: unused slot
+    uint16_t rsv;
+    uint32_t value;
+} KV_RECORD;
+
+// One 64 byte flash page, written once after erase
+typedef struct {
+    uint32_t seq;       // increments with each page written
+    uint16_t magic;
+    uint16_t crc;       // CRC16 of page, with crc field zero
+    KV_RECORD rec[KV_PAGE_RECORDS];
+} KV_PAGE;
+
+void     kv_init(void);
+uint32_t kv_get(KV_KEY key, uint32_t def);
+void     kv_set(KV_KEY key, uint32_t value);
+int      kv_save(void);
+
+#endif /* USER_KVSTORE_H_ */
@@ -0,0 +1,419 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : la.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Logic analyzer, GPIO port input register sampled by DMA
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  la c|d <hz> [<pin> rise|fall|both [pre%]]
+  la dump
+
+  TIM2 update events pace DMA1 channel 2, which copies the low byte of
+  GPIOC->INDR or GPIOD->INDR (pins 0..7) into la_buf, one byte per sample,
+  without the core.  la_buf is the shared scratch buffer (scratch.h), so
+  "la dump" has nothing to print once another command has taken it.  The rate is HCLK / n, n >= LA_MIN_DIV (6 MHz at 48 MHz).
+
+  Without a trigger the buffer is filled once.  With a trigger pin (0..7,
+  same port) the DMA runs circular: once pre% of the buffer holds data, the
+  pin's EXTI line is enabled, and the EXTI7_0_IRQHandler hook (edge.c)
+  records the sample count.  Buffer wraps are counted by the DMA1 channel 2
+  transfer complete interrupt (spi_dma_rx_hook, spi.c), so the count since
+  the start is exact however late the foreground looks.
+  The foreground stops the timer after the remaining post-trigger samples,
+  so the last LA_SAMPLES samples are kept.  If the foreground is late by
+  more than the pre-trigger part (interrupts, fast rates), the trigger has
+  been overwritten: the capture fails rather than report a wrong index.  The interrupt runs a few samples
+  after the edge at high rates; the edge is searched for in the data, up to
+  LA_REFINE samples back.  Any console key stops the wait.
+
+  The capture is printed run-length encoded:
+    LA <port> <rate_hz> <samples> <trigger sample or -1>
+    <hex value>[x<run length>] ...  (LA_RUNS_PER_LINE per line)
+    END
+  tools/la2vcd.py converts a console log to VCD for sigrok/PulseView.
+
+  DMA1 channel 2 is shared with SPI RX, so a capture refuses to start while
+  SPI or WS2812 DMA is active.  TIM2 is shared with "lat fast" and the
+  encoder, "enc stop" first.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "spi.h"
+#include "ws2812.h"
+#include "edge.h"
+#include "enc.h"
+#include "wdog.h"
+#include "scratch.h"
+#include "la.h"
+
+#if LA_SAMPLES > SCRATCH_SIZE
+#error "LA_SAMPLES: the capture must fit the scratch buffer"
+#endif
+
+static uint8_t * la_buf;                    // scratch buffer, SCRATCH_LA
+static volatile uint32_t la_trigger_at;     // la_count_now() when the trigger interrupt ran
+static volatile uint16_t la_laps;           // buffer wraps, triggered capture
+static volatile uint8_t la_triggered;
+static volatile uint8_t la_active;
+static uint32_t la_line;                    // EXTI line of the trigger pin
+
+// Last capture, for "la dump"
+static char la_port;
+static uint32_t la_rate;
+static uint16_t la_first;                   // buffer index of the oldest sample
+static uint16_t la_count;                   // valid samples
+static int16_t la_trigger;                  // trigger sample, from the oldest, -1 none
+
+// DMA buffer index of the next sample to be written
+static uint16_t la_position(uint16_t cntr)
+{
+    return (uint16_t)((LA_SAMPLES - cntr) & (LA_SAMPLES - 1));
+}
+
+// Samples written since a triggered capture started.  A wrap not yet
+// counted by la_lap_hook() is pending in TC2, the index is then near 0.
+// Call from an interrupt or with interrupts disabled.
+static uint32_t la_count_now(void)
+{
+    uint16_t position = la_position((uint16_t)DMA1_Channel2->CNTR);
+    uint32_t laps = la_laps;
+    if((DMA1->INTFR & DMA1_FLAG_TC2) && position < LA_SAMPLES / 2) laps++;
+    return laps * LA_SAMPLES + position;
+}
+
+// la_count_now() from the foreground
+static uint32_t la_samples(void)
+{
+    __disable_irq();
+    uint32_t count = la_count_now();
+    __enable_irq();
+    return count;
+}
+
+// Buffer wrapped, DMA1_Channel2_IRQHandler hook, see spi.c
+static void la_lap_hook(void)
+{
+    if(!(DMA1->INTFR & DMA1_FLAG_TC2)) return;
+    la_laps++;
+    DMA1->INTFCR = DMA1_FLAG_GL2;
+}
+
+// Trigger edge, EXTI7_0_IRQHandler hook, see edge.c.  Note the sample
+// count and disarm.
+static void la_trigger_hook(void)
+{
+    if(!(EXTI->INTFR & la_line)) return;
+    la_trigger_at = la_count_now();
+    EXTI->INTENR &= ~la_line;
+    EXTI->INTFR = la_line;
+    la_triggered = 1;
+}
+
+// Return non-zero while a capture is running
+int la_busy(void)
+{
+    return la_active;
+}
+
+static void la_exti_config(uint8_t port_source, uint8_t pin, LA_EDGE edge, FunctionalState state)
+{
+    EXTI_InitTypeDef EXTI_InitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    la_line = EXTI_Line0 << pin;
+    edge_exti_hook = (state == ENABLE) ? la_trigger_hook : NULL;
+    if(state == ENABLE) GPIO_EXTILineConfig(port_source, pin);
+    EXTI_InitStructure.EXTI_Line = la_line;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = (edge == LA_EDGE_RISE) ? EXTI_Trigger_Rising :
+                                      (edge == LA_EDGE_FALL) ? EXTI_Trigger_Falling :
+                                      EXTI_Trigger_Rising_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = state;
+    EXTI->INTFR = la_line;
+    EXTI_Init(&EXTI_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI7_0_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = (state == ENABLE || edge_lines()) ? ENABLE : DISABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+// DMA1 channel 2 interrupt, counts wraps at the trigger's priority so
+// neither interrupt splits the other's count
+static void la_dma_irq_config(uint8_t preemption)
+{
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = preemption;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+// TIM2 update at HCLK / div, each update requests one DMA1 channel 2 transfer
+static uint32_t la_timer_start(uint32_t div)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
+    uint32_t psc = (div + 0xFFFF) >> 16;    // smallest prescaler with a 16-bit period
+    uint32_t period = div / psc;
+
+    TIM_DeInit(TIM2);
+    TIM_TimeBaseInitStructure.TIM_Period = (uint16_t)(period - 1);
+    TIM_TimeBaseInitStructure.TIM_Prescaler = (uint16_t)(psc - 1);
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseInitStructure);
+    TIM_DMACmd(TIM2, TIM_DMA_Update, ENABLE);
+    TIM_Cmd(TIM2, ENABLE);
+    return SystemCoreClock / (psc * period);
+}
+
+static void la_stop(void)
+{
+    TIM_Cmd(TIM2, DISABLE);
+    TIM_DMACmd(TIM2, TIM_DMA_Update, DISABLE);
+    DMA_Cmd(DMA1_Channel2, DISABLE);
+}
+
+// Wait for the DMA to reach done(), console key or time-out ends it early
+static int la_wait(int (*done)(void), uint32_t timeout_ms)
+{
+    uint32_t start = Millis();
+    while(!done()) {
+        if(USART1->STATR & USART_FLAG_RXNE) {
+            (void)USART1->DATAR;
+            return 0;
+        }
+        if(Millis() - start >= timeout_ms) return 0;
+        wdog_kick(); // bounded by timeout_ms
+    }
+    return 1;
+}
+
+static uint16_t la_pre, la_post;
+
+static int la_done_full(void)
+{
+    return DMA_GetFlagStatus(DMA1_FLAG_TC2) != RESET;
+}
+
+static int la_done_pre(void)
+{
+    return la_samples() >= la_pre;
+}
+
+static int la_done_triggered(void)
+{
+    return la_triggered;
+}
+
+static int la_done_post(void)
+{
+    return la_samples() - la_trigger_at >= la_post;
+}
+
+// Move the trigger back to the edge itself, interrupt latency at high rates
+static int16_t la_refine(int16_t trigger, uint8_t pin, LA_EDGE edge)
+{
+    for(int16_t s = trigger; s > 0 && s > trigger - LA_REFINE; s--) {
+        uint8_t before = (la_buf[(la_first + s - 1) & (LA_SAMPLES - 1)] >> pin) & 1;
+        uint8_t after = (la_buf[(la_first + s) & (LA_SAMPLES - 1)] >> pin) & 1;
+        if(before == after) continue;
+        if(edge == LA_EDGE_BOTH || after == (edge == LA_EDGE_RISE)) return s;
+    }
+    return trigger;
+}
+
+/*********************************************************************
+ * @fn      la_capture
+ *
+ * @brief   Capture LA_SAMPLES samples of a port's input register.
+ *
+ * @param   port - 'C' or 'D'
+ *          div - HCLK cycles per sample, >= LA_MIN_DIV
+ *          pin - trigger pin 0..7, on the same port
+ *          edge - LA_EDGE_NONE for an immediate capture
+ *          pre - pre-trigger samples
+ *
+ * @return  0 on success, -1 if DMA channel 2 or TIM2 is in use,
+ *          -2 if stopped by a key, or no trigger before the time-out,
+ *          -3 if the trigger pin's EXTI line is in use by edge.c,
+ *          -4 if the samples after the trigger overwrote it
+ */
+static int la_capture(char port, uint32_t div, uint8_t pin, LA_EDGE edge, uint16_t pre)
+{
+    DMA_InitTypeDef DMA_InitStructure = {0};
+    GPIO_TypeDef * gpio = (port == 'C') ? GPIOC : GPIOD;
+    uint8_t port_source = (port == 'C') ? GPIO_PortSourceGPIOC : GPIO_PortSourceGPIOD;
+    int status = 0;
+
+    if(spi_dma_busy() || ws2812_busy() || enc_timer() == TIM2) return -1;
+    if(edge != LA_EDGE_NONE && (edge_lines() & (1 << pin))) return -3;
+
+    la_buf = scratch_take(SCRATCH_LA);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO | RCC_APB2Periph_GPIOC | RCC_APB2Periph_GPIOD, ENABLE);
+
+    DMA_DeInit(DMA1_Channel2);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&gpio->INDR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)la_buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = LA_SAMPLES;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = edge ? DMA_Mode_Circular : DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel2, &DMA_InitStructure);
+    DMA_ClearFlag(DMA1_FLAG_GL2);
+    la_laps = 0;
+    if(edge != LA_EDGE_NONE) {
+        spi_dma_rx_hook = la_lap_hook;
+        la_dma_irq_config(0);
+        DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, ENABLE);
+    }
+
+    la_port = port;
+    la_first = 0;
+    la_count = 0;
+    la_trigger = -1;
+    la_triggered = 0;
+    la_pre = pre;
+    la_post = LA_SAMPLES - pre;
+    la_active = 1;
+    DMA_Cmd(DMA1_Channel2, ENABLE);
+    la_rate = la_timer_start(div);
+
+    if(edge == LA_EDGE_NONE) {
+        if(!la_wait(la_done_full, LA_TIMEOUT_MS)) status = -2;
+    }
+    else {
+        // Arm once the pre-trigger part holds samples
+        if(la_wait(la_done_pre, LA_TIMEOUT_MS)) {
+            la_exti_config(port_source, pin, edge, ENABLE);
+            if(la_wait(la_done_triggered, LA_TIMEOUT_MS))
+                la_wait(la_done_post, LA_TIMEOUT_MS);
+        }
+        if(!la_triggered) status = -2;
+    }
+    la_stop();
+    la_active = 0;
+
+    if(edge == LA_EDGE_NONE) {
+        uint16_t end = la_position((uint16_t)DMA1_Channel2->CNTR);
+        la_count = la_done_full() ? LA_SAMPLES : end;
+        return status;
+    }
+
+    // Oldest sample follows the newest once the buffer has wrapped
+    uint32_t end = la_samples();
+    la_exti_config(port_source, pin, edge, DISABLE);
+    DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, DISABLE);
+    spi_dma_rx_hook = NULL;
+    la_dma_irq_config(SPI_DMA_PRIORITY);
+    if(end >= LA_SAMPLES) {
+        la_first = (uint16_t)(end & (LA_SAMPLES - 1));
+        la_count = LA_SAMPLES;
+    }
+    else
+        la_count = (uint16_t)end;
+    if(la_triggered) {
+        uint32_t since = end - la_trigger_at;
+        if(since > la_count) return -4;
+        la_trigger = la_refine((int16_t)(la_count - since), pin, edge);
+    }
+    return status;
+}
+
+// Print the last capture run-length encoded, see the note above
+static void la_dump(void)
+{
+    uint16_t runs = 0;
+
+    printf("LA %c %u %u %d\r\n", la_port, la_rate, la_count, la_trigger);
+    for(uint16_t i = 0; i < la_count;) {
+        uint8_t value = la_buf[(la_first + i) & (LA_SAMPLES - 1)];
+        uint16_t n = 1;
+        while(i + n < la_count && la_buf[(la_first + i + n) & (LA_SAMPLES - 1)] == value) n++;
+        if(n > 1)
+            printf("%02Xx%u", value, n);
+        else
+            printf("%02X", value);
+        i += n;
+        printf((++runs % LA_RUNS_PER_LINE && i < la_count) ? " " : "\r\n");
+    }
+    printf("END\r\n");
+}
+
+// la c|d <hz> [<pin> rise|fall|both [pre%]]
+// la dump
+int cl_la(void)
+{
+    static const char * const edges[] = {"none", "rise", "fall", "both"};
+    LA_EDGE edge = LA_EDGE_NONE;
+    uint8_t pin = 0;
+    uint32_t pre = LA_PRE_DEFAULT;
+
+    if(strcmp(argv[1], "dump") == 0) {
+        if(!la_count || scratch_owner() != SCRATCH_LA) {
+            printf("No capture\r\n");
+            return 1;
+        }
+        la_dump();
+        return 0;
+    }
+
+    char port = (char)(argv[1][0] & ~0x20); // upper case
+    uint32_t rate = (argc > 2) ? strtoul(argv[2], NULL, 0) : 0;
+    if((port != 'C' && port != 'D') || argv[1][1] || !rate) {
+        printf("Usage: la c|d <hz> [<pin> rise|fall|both [pre%%]] | la dump\r\n");
+        return 1;
+    }
+    uint32_t div = SystemCoreClock / rate;
+    if(div < LA_MIN_DIV) {
+        printf("Rate: up to %u Hz\r\n", SystemCoreClock / LA_MIN_DIV);
+        return 1;
+    }
+    if(argc > 3) {
+        const char * name = (argc > 4) ? argv[4] : "";
+        pin = (uint8_t)strtoul(argv[3], NULL, 0);
+        for(edge = LA_EDGE_RISE; edge <= LA_EDGE_BOTH; edge++)
+            if(strcmp(name, edges[edge]) == 0) break;
+        if(argc > 5) pre = strtoul(argv[5], NULL, 0);
+        if(pin > 7 || edge > LA_EDGE_BOTH || pre < LA_PRE_MIN || pre > LA_PRE_MAX) {
+            printf("Trigger: <pin 0-7> rise|fall|both [pre %u-%u%%]\r\n", LA_PRE_MIN, LA_PRE_MAX);
+            return 1;
+        }
+    }
+
+    printf("P%c0-7, %u samples at HCLK / %u, trigger %s", port, LA_SAMPLES, div, edges[edge]);
+    if(edge) printf(" P%c%u, %u%% before", port, pin, pre);
+    printf("\r\n");
+
+    int status = la_capture(port, div, pin, edge, (uint16_t)(LA_SAMPLES * pre / 100));
+    if(status == -1) {
+        printf("DMA or TIM2 (enc) active, try again\r\n");
+        return 1;
+    }
+    if(status == -3) {
+        printf("EXTI line %u in use, edge off %u\r\n", pin, pin);
+        return 1;
+    }
+    if(status == -4) printf("Trigger overwritten, try a lower rate or more pre%%\r\n");
+    if(status == -2) printf(edge ? "No trigger\r\n" : "Stopped\r\n");
+    if(la_count) la_dump();
+    return status ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : la.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Logic analyzer, GPIO port input register sampled by DMA
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_LA_H_
+#define USER_LA_H_
+
+#include <stdint.h>
+
+#ifndef LA_SAMPLES
+#define LA_SAMPLES        256     // capture buffer, one byte (8 pins) per sample, power of 2
+#endif
+#define LA_MIN_DIV        8       // fastest rate HCLK / 8, DMA transfer time per sample
+#define LA_PRE_MIN        10      // pre-trigger share of the buffer, percent
+#define LA_PRE_MAX        90
+#define LA_PRE_DEFAULT    25
+#define LA_TIMEOUT_MS     10000   // give up waiting for the trigger
+#define LA_REFINE         8       // samples searched back for the trigger edge
+#define LA_RUNS_PER_LINE  16      // RLE export
+
+typedef enum {
+    LA_EDGE_NONE = 0,
+    LA_EDGE_RISE,
+    LA_EDGE_FALL,
+    LA_EDGE_BOTH,
+} LA_EDGE;
+
+int la_busy(void);
+
+#endif /* USER_LA_H_ */
@@ -0,0 +1,234 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : lat.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Interrupt entry latency and jitter self-test
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  A timer counts HCLK, and its channel 1 compare raises an interrupt.  The
+  first thing the handler does is read the counter, so (CNT - CH1CVR) is the
+  entry latency in core cycles, plus the few cycles of the counter read.
+  Samples are collected into a histogram with min/avg/max, jitter is max - min.
+
+  lat fast|sw [group] [none|irq|console]
+    fast:  TIM2 handler, "WCH-Interrupt-fast", hardware prologue/epilogue
+           (HPE, INTSYSCR bit 0) saves registers
+    sw:    TIM1 CC handler, standard interrupt attribute, HPE turned off for
+           the run, the compiler's prologue saves registers
+    group: NVIC_PriorityGroupConfig() setting for the run, 0..4, default 2.
+           The measured interrupt gets preemption priority 1, the irq load
+           preemption priority 0.  With group 0 no preemption bit is set, so
+           the measured interrupt waits for the load handler to finish.
+    irq:     SysTick compare interrupt every LAT_LOAD_PERIOD cycles, whose
+             handler (power.c, with the lat_load() hook) runs for
+             ~LAT_LOAD_CYCLES
+    console: foreground keeps printing while samples are taken
+
+  With HPE off, any "WCH-Interrupt-fast" handler that runs would corrupt
+  registers.  For the "sw" run every interrupt other than TIM1 CC and the
+  irq load is disabled in the PFIC, and the enables are put back after, so
+  no other handler, fast or not, runs.  Their requests stay pending and are
+  served after the run, repeats of one request within the run merge (edge
+  counts, encoder overflows), and a WS2812 frame may glitch.  The WWDG is
+  fed from the wait, its early warning can't run.  NMI and HardFault can't
+  be disabled, a fault during the run resets with a wrong snapshot.
+  TIM1 is shared with the servo output, run "servo" again afterwards.
+  Neither test runs on the timer the encoder (enc.c) is using.  The TIM1 CC
+  and TIM2 handlers are in enc.c, they read the counter and pass it to
+  lat_sample() through enc_timer_hook.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "power.h"
+#include "enc.h"
+#include "wdog.h"
+
+#define LAT_PERIOD          997     // timer period, cycles, prime to avoid locking to the load
+#define LAT_COMPARE         500     // compare point within the period
+#define LAT_SAMPLES         1000
+#define LAT_BUCKETS         16
+#define LAT_BUCKET_SHIFT    3       // 8 cycles per histogram bucket
+#define LAT_LOAD_PERIOD     1500    // SysTick load interrupt period, cycles
+#define LAT_LOAD_CYCLES     200     // approximate time spent in the load handler
+#define LAT_HPE             0x01    // INTSYSCR (CSR 0x804) hardware prologue/epilogue enable
+#define LAT_PFIC_IRQS       0xFFFFF000  // PFIC enable word 0 from SysTick (12) up, below are exceptions
+
+extern __IO uint32_t NVIC_Priority_Group; // ch32v00x_misc.c
+
+static volatile uint16_t lat_hist[LAT_BUCKETS];
+static volatile uint16_t lat_count;
+static volatile uint16_t lat_min;
+static volatile uint16_t lat_max;
+static volatile uint32_t lat_sum;
+static volatile uint32_t lat_load_count;
+
+// Measured interrupt, enc_timer_hook, the handler has already read the counter
+static void lat_sample(TIM_TypeDef * tim, uint16_t now)
+{
+    uint16_t latency = (uint16_t)(now - tim->CH1CVR);
+    tim->INTFR = (uint16_t)~TIM_IT_CC1;
+
+    uint16_t bucket = latency >> LAT_BUCKET_SHIFT;
+    if(bucket >= LAT_BUCKETS) bucket = LAT_BUCKETS - 1;
+    lat_hist[bucket]++;
+    if(latency < lat_min) lat_min = latency;
+    if(latency > lat_max) lat_max = latency;
+    lat_sum += latency;
+    if(++lat_count >= LAT_SAMPLES) tim->DMAINTENR &= (uint16_t)~TIM_IT_CC1;
+}
+
+// Competing interrupt load, SysTick compare hook, see power.c
+static void lat_load(void)
+{
+    SysTick->CMP = SysTick->CNT + LAT_LOAD_PERIOD;
+    for(volatile int i = 0; i < LAT_LOAD_CYCLES / 8; i++);
+    lat_load_count++;
+}
+
+static uint32_t lat_intsyscr_read(void)
+{
+    uint32_t value;
+    __asm volatile("csrr %0, 0x804" : "=r"(value));
+    return value;
+}
+
+static void lat_intsyscr_write(uint32_t value)
+{
+    __asm volatile("csrw 0x804, %0" : : "r"(value));
+}
+
+static void lat_irq_config(IRQn_Type irq, uint8_t preemption, FunctionalState state)
+{
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+    NVIC_InitStructure.NVIC_IRQChannel = irq;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = preemption;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = state;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+// Free-running timer at HCLK with channel 1 compare interrupt
+static void lat_timer_start(TIM_TypeDef * tim)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
+
+    if(tim == TIM1)
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM1, ENABLE);
+    else
+        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+    TIM_DeInit(tim);
+    TIM_TimeBaseInitStructure.TIM_Period = LAT_PERIOD - 1;
+    TIM_TimeBaseInitStructure.TIM_Prescaler = 0;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(tim, &TIM_TimeBaseInitStructure);
+    tim->CH1CVR = LAT_COMPARE;
+    tim->INTFR = 0;
+    tim->DMAINTENR = TIM_IT_CC1;
+    TIM_Cmd(tim, ENABLE);
+}
+
+static void lat_report(void)
+{
+    uint32_t count = lat_count ? lat_count : 1;
+    printf("%u samples, min %u, avg %u, max %u, jitter %u cycles, %u load interrupts\r\n",
+           lat_count, lat_min, lat_sum / count, lat_max, lat_max - lat_min, lat_load_count);
+    for(int i = 0; i < LAT_BUCKETS; i++) {
+        if(!lat_hist[i]) continue;
+        if(i == LAT_BUCKETS - 1)
+            printf("%4u+   : %5u\r\n", i << LAT_BUCKET_SHIFT, lat_hist[i]);
+        else
+            printf("%4u-%3u: %5u\r\n", i << LAT_BUCKET_SHIFT, ((i + 1) << LAT_BUCKET_SHIFT) - 1, lat_hist[i]);
+    }
+}
+
+// lat fast|sw [group] [none|irq|console], measure interrupt entry latency
+int cl_lat(void)
+{
+    uint8_t sw = (strcmp(argv[1], "sw") == 0);
+    uint32_t group = (argc > 2) ? strtoul(argv[2], NULL, 0) : NVIC_PriorityGroup_2;
+    const char * load = (argc > 3) ? argv[3] : "none";
+    uint8_t load_irq = (strcmp(load, "irq") == 0);
+    uint8_t load_console = (strcmp(load, "console") == 0);
+
+    if((!sw && strcmp(argv[1], "fast")) || group > NVIC_PriorityGroup_4) {
+        printf("Usage: lat fast|sw [group 0-4] [none|irq|console]\r\n");
+        return 1;
+    }
+
+    TIM_TypeDef * tim = sw ? TIM1 : TIM2;
+    IRQn_Type irq = sw ? TIM1_CC_IRQn : TIM2_IRQn;
+    if(enc_timer() == tim) {
+        printf("TIM%u in use by enc\r\n", sw ? 1 : 2);
+        return 1;
+    }
+    uint32_t saved_group = NVIC_Priority_Group;
+    uint32_t saved_intsyscr = lat_intsyscr_read();
+    uint32_t saved_enable[2] = {NVIC->ISR[0], NVIC->ISR[1]};   // IRQs 12..38
+
+    memset((void *)lat_hist, 0, sizeof(lat_hist));
+    lat_count = 0;
+    lat_min = 0xFFFF;
+    lat_max = 0;
+    lat_sum = 0;
+    lat_load_count = 0;
+
+    printf("%s, group %u, load %s\r\n", sw ? "sw" : "fast", group, load);
+    enc_timer_hook = lat_sample;
+    NVIC_PriorityGroupConfig(group);
+    lat_irq_config(irq, 1, ENABLE);
+    if(load_irq) {
+        lat_irq_config(SysTicK_IRQn, 0, ENABLE);
+        power_systick_hook = lat_load;
+        SysTick->SR = 0;
+        SysTick->CMP = SysTick->CNT + LAT_LOAD_PERIOD;
+        SysTick->CTLR |= (1 << 1); // STIE
+    }
+
+    __disable_irq();
+    if(sw) {
+        // Only the measured interrupt and the load may run with HPE off
+        NVIC->IRER[0] = LAT_PFIC_IRQS & ~(uint32_t)(load_irq ? 1 << SysTicK_IRQn : 0);
+        NVIC->IRER[1] = ~(uint32_t)(1 << (TIM1_CC_IRQn - 32));
+        lat_intsyscr_write(saved_intsyscr & ~LAT_HPE);
+    }
+    lat_timer_start(tim);
+    __enable_irq();
+
+    // Wait for samples, LAT_SAMPLES * LAT_PERIOD cycles, give up after 1s
+    uint32_t start = Millis();
+    while(lat_count < LAT_SAMPLES && (Millis() - start) < 1000) {
+        if(load_console) printf(".");
+        wdog_kick(); // bounded, the WWDG interrupt is off for "sw"
+    }
+
+    __disable_irq();
+    TIM_Cmd(tim, DISABLE);
+    tim->DMAINTENR = 0;
+    SysTick->CTLR &= ~(1 << 1);
+    SysTick->SR = 0;
+    power_systick_hook = NULL;
+    enc_timer_hook = NULL;
+    lat_intsyscr_write(saved_intsyscr);
+    if(sw) {
+        NVIC->IENR[0] = saved_enable[0] & LAT_PFIC_IRQS;
+        NVIC->IENR[1] = saved_enable[1];
+    }
+    __enable_irq();
+    lat_irq_config(irq, 1, DISABLE);
+    lat_irq_config(SysTicK_IRQn, 0, ENABLE); // power_idle() wake source
+    NVIC_PriorityGroupConfig(saved_group);
+
+    if(load_console) printf("\r\n");
+    lat_report();
+    return 0;
+}
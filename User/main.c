@@ -12,7 +12,7 @@
  *@Note
   Using peripherals / pins:
   UART: TX: PD5, RX: PD6
-  GPIO: PD0 - LED
+  GPIO: PD0 - LED, not toggled while "opa on" uses it as CHN1
   I2C, SCL: PC2, SDA: PC1
 
 */
@@ -20,6 +20,19 @@
 #include "debug.h"
 #include "command_line.h"
 #include "i2c.h"
+#include "adc.h"
+#include "nor.h"
+#include "kvstore.h"
+#include "evlog.h"
+#include "mem.h"
+#include "pool.h"
+#include "prof.h"
+#include "power.h"
+#include "edge.h"
+#include "enc.h"
+#include "wdog.h"
+#include "ds3231.h"
+#include "opa.h"
 
 // Function Prototypes
 extern void USART_Printf_Init2(uint32_t baudrate); // debug2.c
@@ -60,11 +73,19 @@ int main(void)
 
     NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
     Delay_Init();
-    USART_Printf_Init2(115200); // Use alternate init function that includes RX pin
+    pool_init(); // fixed-block allocator, free lists
+    kv_init(); // settings from flash, rebuild RAM index
+    evlog_init(); // event log, records reset cause
+    USART_Printf_Init2(kv_get(KV_KEY_BAUD, 115200)); // Use alternate init function that includes RX pin
     printf("SystemClk:%d\r\n", SystemCoreClock);
+    wdog_init(kv_get(KV_KEY_WDOG, 0)); // independent watchdog, keeps the culprit of the last reset
 
     //printf("IIC Host mode, 100Kbps\r\n");
-    IIC_Init( 100000, I2C_SELF_ADDRESS); // 80000 creates a nice looking 80KHz, 100K looks good too
+    IIC_Init( kv_get(KV_KEY_I2C_SPEED, 100000), I2C_SELF_ADDRESS); // 80000 creates a nice looking 80KHz, 100K looks good too
+
+    // Calibrate ADC and measure VDD using Vrefint
+    adc_init();
+    printf("VDD: %u mV\r\n", adc_vdd_mv());
 
     //printf("init toggle LED\n");
     GPIO_Toggle_INIT();
@@ -72,10 +93,32 @@ int main(void)
     // Initialize command line module
     cl_setup();
 
+    // WFI idle, woken by SysTick compare or console input
+    power_init();
+
     while(1)
     {
+        PROF_BEGIN(PROF_MAIN_LOOP);
+        wdog_enter(WDOG_TASK_CONSOLE);
         cl_loop(); // command line, check for input character
-        Delay_Ms(40);
-        GPIO_WriteBit(GPIOD, GPIO_Pin_0, (i == 0) ? (i = Bit_SET) : (i = Bit_RESET)); // toggle PD0
+        wdog_checkin(WDOG_TASK_CONSOLE);
+        wdog_enter(WDOG_TASK_NOR);
+        nor_poll(); // background SPI NOR erase
+        wdog_checkin(WDOG_TASK_NOR);
+        wdog_enter(WDOG_TASK_EDGE);
+        edge_poll(); // EXTI edge timestamps to the interval histogram
+        wdog_checkin(WDOG_TASK_EDGE);
+        wdog_enter(WDOG_TASK_ENC);
+        enc_poll(); // encoder velocity estimate
+        wdog_checkin(WDOG_TASK_ENC);
+        wdog_enter(WDOG_TASK_RTC);
+        ds3231_poll(); // DS3231 alarms, HSI discipline to its 1 Hz output
+        wdog_checkin(WDOG_TASK_RTC);
+        mem_check(); // stack guard word
+        Millis(); // keep millisecond count across SysTick wrap
+        wdog_poll(); // feed the watchdog once every task has checked in
+        PROF_END(PROF_MAIN_LOOP);
+        if(power_idle(40) && !opa_uses_pd0()) // sleep, 40ms period, returns early for console input
+            GPIO_WriteBit(GPIOD, GPIO_Pin_0, (i == 0) ? (i = Bit_SET) : (i = Bit_RESET)); // toggle PD0
     }
 }
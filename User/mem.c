@@ -0,0 +1,103 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mem.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : RAM budget reporting and stack watermarking
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  RAM layout, from Ld/Link.ld:
+      .data | .ramfunc | .bss | .noinit | heap (_end.._heap_end) | stack (__stack_size)
+  The updater's code (.update, see update.c) is linked over .bss and only
+  copied there by "update".
+  Startup paints everything from _end to the top of the stack with MEM_PAINT.
+  The deepest stack use is then the lowest word above the heap break that no
+  longer holds the pattern.
+
+  The bottom word of the reserved stack is the guard.  mem_check(), called from
+  the main loop, reports (once) and logs EVLOG_STACK when the guard has been
+  overwritten, i.e. the stack has outgrown __stack_size and is heading for the
+  heap and .bss.
+*/
+
+#include <stddef.h>
+#include "debug.h"
+#include "command_line.h"
+#include "evlog.h"
+#include "mem.h"
+
+// Linker symbols
+extern uint32_t _data_vma[], _edata[];
+extern uint32_t _ramfunc_vma[], _eramfunc[];
+extern uint32_t _sbss[], _ebss[];
+extern uint32_t _update_vma[], _eupdate[];
+extern uint32_t _snoinit[], _enoinit[];
+extern uint32_t _end[], _heap_end[];
+extern uint32_t _susrstack[], _eusrstack[];
+
+extern void * _sbrk(ptrdiff_t incr); // debug.c
+
+static uint8_t mem_guard_reported;
+
+// Current heap break, rounded up to a word
+static uint32_t * mem_heap_break(void)
+{
+    return (uint32_t *)(((uintptr_t)_sbrk(0) + 3) & ~3UL);
+}
+
+// Return the stack high-water mark, in bytes, since reset
+uint32_t mem_stack_used(void)
+{
+    uint32_t * p = mem_heap_break();
+    while(p < _eusrstack && *p == MEM_PAINT) p++;
+    return (uint32_t)((uintptr_t)_eusrstack - (uintptr_t)p);
+}
+
+/*********************************************************************
+ * @fn      mem_check
+ *
+ * @brief   Verify the stack guard word.  On first failure, display a
+ *          warning and record EVLOG_STACK with the high-water mark.
+ *
+ * @return  0 if the guard is intact, -1 if overwritten
+ */
+int mem_check(void)
+{
+    if(*_susrstack == MEM_PAINT) return 0;
+    if(!mem_guard_reported) {
+        mem_guard_reported = 1;
+        uint32_t used = mem_stack_used();
+        printf("\r\nStack overflow: %u of %u bytes used\r\n", used,
+               (uint32_t)((uintptr_t)_eusrstack - (uintptr_t)_susrstack));
+        evlog_event(EVLOG_STACK, (uint16_t)used);
+    }
+    return -1;
+}
+
+#define MEM_SIZE(start, end)  ((uint32_t)((uintptr_t)(end) - (uintptr_t)(start)))
+
+// Display RAM usage by region, stack high-water mark, and free RAM
+int cl_mem(void)
+{
+    uint32_t * brk = mem_heap_break();
+    uint32_t stack_size = MEM_SIZE(_susrstack, _eusrstack);
+    uint32_t stack_used = mem_stack_used();
+
+    printf(".data:    %08X %5u bytes\r\n", (uint32_t)_data_vma, MEM_SIZE(_data_vma, _edata));
+    printf(".ramfunc: %08X %5u bytes\r\n", (uint32_t)_ramfunc_vma, MEM_SIZE(_ramfunc_vma, _eramfunc));
+    printf(".bss:     %08X %5u bytes\r\n", (uint32_t)_sbss, MEM_SIZE(_sbss, _ebss));
+    printf(".update:  %08X %5u bytes, over .bss while updating\r\n", (uint32_t)_update_vma,
+           MEM_SIZE(_update_vma, _eupdate));
+    printf(".noinit:  %08X %5u bytes\r\n", (uint32_t)_snoinit, MEM_SIZE(_snoinit, _enoinit));
+    printf("heap:     %08X %5u bytes used, limit %08X (%u bytes)\r\n", (uint32_t)_end,
+           MEM_SIZE(_end, brk), (uint32_t)_heap_end, MEM_SIZE(_end, _heap_end));
+    printf("stack:    %08X %5u bytes, high-water %u (%u%%)%s\r\n", (uint32_t)_susrstack, stack_size,
+           stack_used, stack_used * 100 / stack_size, (*_susrstack == MEM_PAINT) ? "" : ", GUARD OVERWRITTEN");
+    printf("free:     %5u bytes between heap and deepest stack\r\n",
+           MEM_SIZE(brk, (uintptr_t)_eusrstack - stack_used));
+    return 0;
+}
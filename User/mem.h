@@ -0,0 +1,22 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : mem.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : RAM budget reporting and stack watermarking
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_MEM_H_
+#define USER_MEM_H_
+
+#include <stdint.h>
+
+// Pattern written from _end to the top of the stack by startup_ch32v00x.S
+#define MEM_PAINT   0xA5A5A5A5UL
+
+uint32_t mem_stack_used(void);
+int      mem_check(void);
+
+#endif /* USER_MEM_H_ */
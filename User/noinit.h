@@ -0,0 +1,21 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : noinit.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Place selected variables in RAM that survives reset
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_NOINIT_H_
+#define USER_NOINIT_H_
+
+// Variables marked NOINIT are linked into .noinit (Ld/Link.ld), after .bss
+// and below the stack paint.  startup_ch32v00x.S neither zeroes nor paints
+// them, so a value written before a watchdog or software reset is still
+// there after it.  At power-up the contents are random, validate with a
+// magic number and range checks before use.
+#define NOINIT    __attribute__((section(".noinit")))
+
+#endif /* USER_NOINIT_H_ */
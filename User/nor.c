@@ -0,0 +1,304 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : nor.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : W25Qxx class SPI NOR flash driver, on SPI1
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Uses SPI1 and its software chip select, see spi.c for pins.
+
+  Page program is pipelined: each page is sent by DMA and the function returns
+  while the device is still programming.  The busy flag is checked at the start
+  of the next operation, so the device programs page N while we set up page N+1.
+
+  Sector erase runs in the background.  nor_erase_start() issues the command and
+  returns, nor_poll(), called from the main loop, checks the busy flag and
+  reports completion.  Other operations wait for a pending erase to finish.
+
+  Nothing is sent while another driver's SPI DMA transfer runs: reads and
+  writes return NOR_ERROR_BUSY, nor_poll() tries again next time.  "nor"
+  moves data through the shared scratch buffer (scratch.h), one whole page
+  at a time.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "spi.h"
+#include "scratch.h"
+#include "wdog.h"
+#include "nor.h"
+
+#if NOR_PAGE_SIZE > SCRATCH_SIZE
+#error "NOR_PAGE_SIZE: a page must fit the scratch buffer"
+#endif
+
+static uint32_t nor_id;           // JEDEC ID, manufacturer:type:capacity
+static uint8_t  nor_erasing;      // background sector erase in progress
+static uint32_t nor_erase_address;
+
+// Select SPI1 configuration for NOR flash (SPI1 may be shared with other drivers)
+static void nor_select(void)
+{
+    spi_init(NOR_SPI_MODE, NOR_SPI_PRESCALER, SPI_DataSize_8b);
+}
+
+// Send command byte followed by 24-bit address, leave CS asserted
+static void nor_command_address(uint8_t cmd, uint32_t address)
+{
+    spi_cs(1);
+    spi_transfer(cmd);
+    spi_transfer((uint8_t)(address >> 16));
+    spi_transfer((uint8_t)(address >> 8));
+    spi_transfer((uint8_t)address);
+}
+
+static uint8_t nor_read_status(void)
+{
+    spi_cs(1);
+    spi_transfer(NOR_CMD_READ_STATUS1);
+    uint8_t status = (uint8_t)spi_transfer(0xFF);
+    spi_cs(0);
+    return status;
+}
+
+static void nor_write_enable(void)
+{
+    spi_cs(1);
+    spi_transfer(NOR_CMD_WRITE_ENABLE);
+    spi_cs(0);
+}
+
+// Wake device and read JEDEC ID.  Return NOR_ERROR_SUCCESS or NOR_ERROR_ABSENT
+int nor_init(void)
+{
+    nor_select();
+    spi_cs(1);
+    spi_transfer(NOR_CMD_RELEASE_PD);
+    spi_cs(0);
+    Delay_Us(5); // tRES1, 3us
+
+    nor_id = nor_jedec_id();
+    if(nor_id == 0 || nor_id == 0xFFFFFF) {
+        nor_id = 0;
+        return NOR_ERROR_ABSENT;
+    }
+    return NOR_ERROR_SUCCESS;
+}
+
+// Return 24-bit JEDEC ID: manufacturer, memory type, capacity
+uint32_t nor_jedec_id(void)
+{
+    uint8_t id[3];
+    spi_cs(1);
+    spi_transfer(NOR_CMD_JEDEC_ID);
+    spi_transfer_buf(NULL, id, sizeof(id));
+    spi_cs(0);
+    return ((uint32_t)id[0] << 16) | ((uint32_t)id[1] << 8) | id[2];
+}
+
+// Return device capacity in bytes, from the JEDEC capacity code (2^n bytes)
+uint32_t nor_capacity(void)
+{
+    uint8_t code = (uint8_t)nor_id;
+    return (code >= 0x10 && code < 0x20) ? (1UL << code) : 0;
+}
+
+// Spin, waiting for device busy flag to clear
+// Return NOR_ERROR_SUCCESS or NOR_ERROR_TIME_OUT
+int nor_wait_ready(void)
+{
+    uint32_t start = Millis();
+    while(nor_read_status() & NOR_STATUS_BUSY) {
+        if(Millis() - start >= NOR_BUSY_MS)
+            return NOR_ERROR_TIME_OUT;
+        wdog_kick(); // bounded by NOR_BUSY_MS
+    }
+    nor_erasing = 0;
+    return NOR_ERROR_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      nor_read
+ *
+ * @brief   Fast read (0x0B), data phase transferred by DMA.
+ *
+ * @return  NOR_ERROR code
+ */
+int nor_read(uint32_t address, uint8_t * data, uint16_t count)
+{
+    if(spi_dma_busy()) return NOR_ERROR_BUSY;
+    int rc = nor_wait_ready();
+    if(NOR_ERROR_SUCCESS != rc) return rc;
+
+    nor_command_address(NOR_CMD_FAST_READ, address);
+    spi_transfer(0xFF); // dummy byte
+    if(SPI_ERROR_SUCCESS != spi_transfer_dma(NULL, data, count, NULL))
+        rc = NOR_ERROR_BUSY;
+    else
+        rc = spi_wait();
+    spi_cs(0);
+    return rc;
+}
+
+/*********************************************************************
+ * @fn      nor_write
+ *
+ * @brief   Program data, splitting at page boundaries.  Area must be erased.
+ *          Returns with the last page still programming.
+ *
+ * @return  NOR_ERROR code
+ */
+int nor_write(uint32_t address, const uint8_t * data, uint16_t count)
+{
+    while(count) {
+        uint16_t chunk = NOR_PAGE_SIZE - (address % NOR_PAGE_SIZE);
+        if(chunk > count) chunk = count;
+
+        if(spi_dma_busy()) return NOR_ERROR_BUSY;
+        int rc = nor_wait_ready(); // previous page (or erase) completes here
+        if(NOR_ERROR_SUCCESS != rc) return rc;
+
+        nor_write_enable();
+        nor_command_address(NOR_CMD_PAGE_PROGRAM, address);
+        if(SPI_ERROR_SUCCESS != spi_transfer_dma(data, NULL, chunk, NULL))
+            rc = NOR_ERROR_BUSY; // CS rises before any data, nothing is programmed
+        else
+            rc = spi_wait();
+        while(SPI1->STATR & SPI_I2S_FLAG_BSY); // last bit out before CS rises
+        spi_cs(0); // device begins programming
+        if(SPI_ERROR_SUCCESS != rc) return rc;
+
+        address += chunk;
+        data += chunk;
+        count -= chunk;
+    }
+    return NOR_ERROR_SUCCESS;
+}
+
+// Begin 4K sector erase, returning immediately.  See nor_poll()
+int nor_erase_start(uint32_t address)
+{
+    int rc = nor_wait_ready();
+    if(NOR_ERROR_SUCCESS != rc) return rc;
+
+    nor_write_enable();
+    nor_command_address(NOR_CMD_SECTOR_ERASE, address);
+    spi_cs(0);
+    nor_erase_address = address & ~(NOR_SECTOR_SIZE - 1);
+    nor_erasing = 1;
+    return NOR_ERROR_SUCCESS;
+}
+
+int nor_erase_busy(void)
+{
+    return nor_erasing;
+}
+
+// Called from main loop, check busy flag of a background erase
+void nor_poll(void)
+{
+    if(!nor_erasing || spi_dma_busy()) return;
+    nor_select(); // SPI1 may be set up for another driver
+    if(nor_read_status() & NOR_STATUS_BUSY) return;
+    nor_erasing = 0;
+    printf("NOR sector %06X erased\r\n>", nor_erase_address);
+}
+
+// Stopwatch using the free-running SysTick counter (HCLK), for throughput reports
+static uint32_t nor_stopwatch;
+
+static void nor_stopwatch_start(void)
+{
+    nor_stopwatch = SysTick->CNT;
+}
+
+static uint32_t nor_stopwatch_us(void)
+{
+    return (SysTick->CNT - nor_stopwatch) / (SystemCoreClock / 1000000);
+}
+
+static void nor_report(const char * op, uint32_t count, uint32_t us)
+{
+    uint32_t bytes = count;
+    while(bytes > 4000000) { bytes >>= 1; us >>= 1; } // keep bytes * 1000 in 32 bits
+    if(!us) us = 1;
+    printf("%s %u bytes in %u us, %u KB/s\r\n", op, count, us, ((bytes * 1000UL) / us) * 1000UL / 1024);
+}
+
+static void nor_dump(uint32_t address, const uint8_t * data, uint16_t count)
+{
+    for(uint16_t i = 0; i < count; i++) {
+        if((i % 16) == 0) printf("%s%06X: ", i ? "\r\n" : "", address + i);
+        printf("%02X ", data[i]);
+    }
+    printf("\r\n");
+}
+
+// nor id
+// nor read <address> [count]   -- count <= NOR_DUMP_MAX: hex dump, else throughput test
+// nor write <address> <count>  -- write incrementing pattern, report throughput
+// nor erase <address>          -- background 4K sector erase
+int cl_nor(void)
+{
+    nor_select();
+    if(strcmp(argv[1], "id") == 0) {
+        if(NOR_ERROR_SUCCESS != nor_init()) {
+            printf("NOR flash not found\r\n");
+            return NOR_ERROR_ABSENT;
+        }
+        printf("JEDEC ID: %06X, %u K bytes\r\n", nor_id, nor_capacity() / 1024);
+        return 0;
+    }
+    if(argc < 3) {
+        printf("Usage: nor id | read <addr> [n] | write <addr> <n> | erase <addr>\r\n");
+        return 1;
+    }
+
+    uint32_t address = strtoul(argv[2], NULL, 16);
+    uint32_t count = (argc > 3) ? strtoul(argv[3], NULL, 0) : 16;
+    uint8_t * data = scratch_take(SCRATCH_NOR);  // NOR_PAGE_SIZE bytes
+    int rc = NOR_ERROR_SUCCESS;
+
+    if(strcmp(argv[1], "read") == 0) {
+        if(count <= NOR_DUMP_MAX) {
+            rc = nor_read(address, data, count);
+            if(NOR_ERROR_SUCCESS == rc) nor_dump(address, data, count);
+        } else {
+            nor_stopwatch_start();
+            for(uint32_t done = 0; done < count && NOR_ERROR_SUCCESS == rc; done += NOR_PAGE_SIZE) {
+                uint16_t chunk = (count - done) < NOR_PAGE_SIZE ? (count - done) : NOR_PAGE_SIZE;
+                rc = nor_read(address + done, data, chunk);
+                wdog_kick(); // count set by the user, one page per pass
+            }
+            nor_report("Read", count, nor_stopwatch_us());
+        }
+    } else if(strcmp(argv[1], "write") == 0) {
+        // Whole pages: the first chunk ends at a page boundary, one program cycle each
+        nor_stopwatch_start();
+        for(uint32_t done = 0; done < count && NOR_ERROR_SUCCESS == rc;) {
+            uint16_t chunk = NOR_PAGE_SIZE - ((address + done) & (NOR_PAGE_SIZE - 1));
+            if(chunk > count - done) chunk = (uint16_t)(count - done);
+            for(uint16_t i = 0; i < chunk; i++) data[i] = (uint8_t)(done + i);
+            rc = nor_write(address + done, data, chunk);
+            wdog_kick(); // count set by the user, one page per pass
+            done += chunk;
+        }
+        if(NOR_ERROR_SUCCESS == rc) rc = nor_wait_ready();
+        nor_report("Wrote", count, nor_stopwatch_us());
+    } else if(strcmp(argv[1], "erase") == 0) {
+        rc = nor_erase_start(address);
+        if(NOR_ERROR_SUCCESS == rc) printf("Erasing sector %06X\r\n", address & ~(NOR_SECTOR_SIZE - 1));
+    } else {
+        printf("Unknown nor command: %s\r\n", argv[1]);
+        return 1;
+    }
+    if(NOR_ERROR_SUCCESS != rc) printf("NOR error: %d\r\n", rc);
+    return rc;
+}
@@ -0,0 +1,51 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : nor.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : W25Qxx class SPI NOR flash driver, on SPI1
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_NOR_H_
+#define USER_NOR_H_
+
+#include <stdint.h>
+
+// W25Qxx command set
+#define NOR_CMD_WRITE_ENABLE    0x06
+#define NOR_CMD_READ_STATUS1    0x05
+#define NOR_CMD_PAGE_PROGRAM    0x02
+#define NOR_CMD_FAST_READ       0x0B
+#define NOR_CMD_SECTOR_ERASE    0x20   // 4K byte sector
+#define NOR_CMD_JEDEC_ID        0x9F
+#define NOR_CMD_RELEASE_PD      0xAB
+
+#define NOR_STATUS_BUSY         0x01
+#define NOR_PAGE_SIZE           256
+#define NOR_SECTOR_SIZE         4096
+#define NOR_DUMP_MAX            64     // "nor read" hex dumps up to this many bytes
+#define NOR_BUSY_MS             500    // page program is ~0.7ms, sector erase up to 400ms
+
+#define NOR_SPI_MODE            0
+#define NOR_SPI_PRESCALER       SPI_BaudRatePrescaler_4   // 48MHz / 4 = 12MHz, slower at lower clocks
+
+typedef enum {
+    NOR_ERROR_SUCCESS  =  0,
+    NOR_ERROR_ABSENT   = -1,  // No valid JEDEC ID
+    NOR_ERROR_TIME_OUT = -2,
+    NOR_ERROR_BUSY     = -3,  // SPI DMA in use by another driver
+} NOR_ERROR;
+
+int      nor_init(void);
+uint32_t nor_jedec_id(void);
+uint32_t nor_capacity(void);
+int      nor_wait_ready(void);
+int      nor_read(uint32_t address, uint8_t * data, uint16_t count);
+int      nor_write(uint32_t address, const uint8_t * data, uint16_t count);
+int      nor_erase_start(uint32_t address);
+int      nor_erase_busy(void);
+void     nor_poll(void);
+
+#endif /* USER_NOR_H_ */
@@ -0,0 +1,124 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : opa.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : On-chip op-amp (OPA) front-end, output routed to ADC
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  OPA pins:
+  Positive input: CHP0: PA2, CHP1: PD7 (NRST pin by default, see user option bytes)
+  Negative input: CHN0: PA1, CHN1: PD0
+  Output: PD4, sampled by ADC channel 7
+
+  PD0 is also the main loop's toggle LED.  While CHN1 holds it as an analog
+  input, opa_uses_pd0() tells main to leave the pin alone; "opa off" makes
+  it a push-pull output again.
+
+  Small sensor signals are amplified in hardware, so a single conversion
+  replaces heavy software oversampling.  Gain is set by external resistors,
+  see OPA_GAIN_X10 in opa.h.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "adc.h"
+#include "opa.h"
+
+static uint8_t opa_pd0; // CHN1 selected, PD0 is an analog input
+
+/*********************************************************************
+ * @fn      opa_init
+ *
+ * @brief   Configure the OPA input pins as analog, select the inputs,
+ *          enable the amplifier, and prepare its ADC channel.
+ *
+ * @param   psel - positive input, CHP0 (PA2) or CHP1 (PD7)
+ *          nsel - negative input, CHN0 (PA1) or CHN1 (PD0)
+ *
+ * @return  none
+ */
+void opa_init(OPA_PSEL_TypeDef psel, OPA_NSEL_TypeDef nsel)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    OPA_InitTypeDef OPA_InitStructure = {0};
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOD, ENABLE);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+
+    GPIO_InitStructure.GPIO_Pin = (psel == CHP0) ? GPIO_Pin_2 : GPIO_Pin_7;
+    GPIO_Init((psel == CHP0) ? GPIOA : GPIOD, &GPIO_InitStructure);
+
+    GPIO_InitStructure.GPIO_Pin = (nsel == CHN0) ? GPIO_Pin_1 : GPIO_Pin_0;
+    GPIO_Init((nsel == CHN0) ? GPIOA : GPIOD, &GPIO_InitStructure);
+    opa_pd0 = (nsel == CHN1);
+
+    OPA_InitStructure.PSEL = psel;
+    OPA_InitStructure.NSEL = nsel;
+    OPA_Init(&OPA_InitStructure);
+    OPA_Cmd(ENABLE);
+
+    adc_channel_config(OPA_ADC_CHANNEL); // PD4, analog
+}
+
+// Disable the amplifier, releasing its output pin, and PD0 back to the LED
+void opa_disable(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+
+    OPA_Cmd(DISABLE);
+    OPA_DeInit();
+    if(opa_pd0) {
+        GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0;
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+        GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+        GPIO_Init(GPIOD, &GPIO_InitStructure);
+        opa_pd0 = 0;
+    }
+}
+
+// CHN1 owns PD0, the LED must not be driven
+int opa_uses_pd0(void)
+{
+    return opa_pd0;
+}
+
+// Convert OPA output millivolts to input referred microvolts
+static uint32_t opa_mv_to_uv(uint32_t mv)
+{
+    return (mv * 10000UL) / OPA_GAIN_X10;
+}
+
+// Sample the OPA output and return the input referred voltage, in microvolts
+uint32_t opa_read_uv(void)
+{
+    return opa_mv_to_uv(adc_read_mv(OPA_ADC_CHANNEL));
+}
+
+// opa on [psel] [nsel], opa off, opa read
+int cl_opa(void)
+{
+    if(strcmp(argv[1], "on") == 0) {
+        OPA_PSEL_TypeDef psel = (argc > 2 && atoi(argv[2])) ? CHP1 : CHP0;
+        OPA_NSEL_TypeDef nsel = (argc > 3 && atoi(argv[3])) ? CHN1 : CHN0;
+        opa_init(psel, nsel);
+        printf("OPA enabled, P: %s, N: %s, gain: %u.%u\r\n", psel == CHP0 ? "PA2" : "PD7",
+                nsel == CHN0 ? "PA1" : "PD0", OPA_GAIN_X10 / 10, OPA_GAIN_X10 % 10);
+    } else if(strcmp(argv[1], "off") == 0) {
+        opa_disable();
+        printf("OPA disabled\r\n");
+    } else if(strcmp(argv[1], "read") == 0) {
+        uint16_t mv = adc_read_mv(OPA_ADC_CHANNEL);
+        printf("OPA out: %u mV, in: %u uV\r\n", mv, opa_mv_to_uv(mv));
+    } else {
+        printf("Usage: opa on [psel 0|1] [nsel 0|1], opa off, opa read\r\n");
+        return 1;
+    }
+    return 0;
+}
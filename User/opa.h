@@ -0,0 +1,29 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : opa.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : On-chip op-amp (OPA) front-end, output routed to ADC
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_OPA_H_
+#define USER_OPA_H_
+
+#include "ch32v00x_opa.h"
+
+#define OPA_ADC_CHANNEL   ADC_Channel_7  // OPA output, PD4, is also ADC channel A7
+
+// Closed loop gain set by external resistors, non-inverting: 1 + Rf/Rg
+// Expressed in tenths, IE: 101 = 10.1x (Rf = 91K, Rg = 10K)
+#ifndef OPA_GAIN_X10
+#define OPA_GAIN_X10      101
+#endif
+
+void     opa_init(OPA_PSEL_TypeDef psel, OPA_NSEL_TypeDef nsel);
+void     opa_disable(void);
+uint32_t opa_read_uv(void);
+int      opa_uses_pd0(void);
+
+#endif /* USER_OPA_H_ */
@@ -0,0 +1,171 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : pool.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Static fixed-block pool allocator
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Each pool is a static array of equal sized blocks.  Free blocks are linked
+  through their first word, so pool_alloc() and pool_free() are a single list
+  operation, O(1), and cannot fragment.  Interrupts are masked during the
+  list operation, so blocks may be allocated and freed from ISRs.
+
+  pool_get()/pool_put() pick the pool by size or by address, for callers that
+  don't care which pool a block comes from.  There is no fallback to a larger
+  pool: an empty pool fails, and counts the failure, every time.
+
+  The allocator is available, unused: no module in the tree allocates from
+  the pools, and none used the heap before them.  Both counts default to 0,
+  with no storage.  A module that needs blocks raises the count for its
+  pool in the build.
+
+  To guarantee nothing uses the newlib heap, build with MALLOC_DISABLE=1,
+  see debug.h.  Linking malloc, calloc, realloc or newlib's _malloc_r then
+  fails the link (ASSERT in Ld/Link.ld), and _sbrk() refuses any request.
+*/
+
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "pool.h"
+
+// No storage while a count is 0
+#if POOL_SMALL_COUNT
+static uint32_t pool_small_storage[POOL_SMALL_SIZE * POOL_SMALL_COUNT / 4];
+#define POOL_SMALL_STORAGE ((uint8_t *)pool_small_storage)
+#else
+#define POOL_SMALL_STORAGE NULL
+#endif
+#if POOL_LARGE_COUNT
+static uint32_t pool_large_storage[POOL_LARGE_SIZE * POOL_LARGE_COUNT / 4];
+#define POOL_LARGE_STORAGE ((uint8_t *)pool_large_storage)
+#else
+#define POOL_LARGE_STORAGE NULL
+#endif
+
+POOL pool_small = {"small", POOL_SMALL_STORAGE, NULL, POOL_SMALL_SIZE, POOL_SMALL_COUNT, 0, 0, 0};
+POOL pool_large = {"large", POOL_LARGE_STORAGE, NULL, POOL_LARGE_SIZE, POOL_LARGE_COUNT, 0, 0, 0};
+
+// Pools in order of increasing block size, for pool_get()
+static POOL * const pools[] = {&pool_small, &pool_large};
+#define POOL_COUNT (sizeof(pools) / sizeof(pools[0]))
+
+// Link all blocks of a pool into its free list, clear statistics
+static void pool_reset(POOL * pool)
+{
+    pool->free_list = NULL;
+    for(int i = pool->count - 1; i >= 0; i--) {
+        POOL_BLOCK * block = (POOL_BLOCK *)(pool->storage + i * pool->block_size);
+        block->next = pool->free_list;
+        pool->free_list = block;
+    }
+    pool->in_use = 0;
+    pool->peak = 0;
+    pool->failures = 0;
+}
+
+/*********************************************************************
+ * @fn      pool_init
+ *
+ * @brief   Build the free list of every pool.  Call once at startup,
+ *          before any pool_alloc().
+ *
+ * @return  none
+ */
+void pool_init(void)
+{
+    for(unsigned i = 0; i < POOL_COUNT; i++)
+        pool_reset(pools[i]);
+}
+
+/*********************************************************************
+ * @fn      pool_alloc
+ *
+ * @brief   Take a block from pool.
+ *
+ * @return  pointer to block, or NULL if the pool is empty
+ */
+void * pool_alloc(POOL * pool)
+{
+    uint32_t mstatus = __get_MSTATUS();
+    __disable_irq();
+    POOL_BLOCK * block = pool->free_list;
+    if(block) {
+        pool->free_list = block->next;
+        if(++pool->in_use > pool->peak) pool->peak = pool->in_use;
+    } else {
+        pool->failures++;
+    }
+    __set_MSTATUS(mstatus);
+    return block;
+}
+
+/*********************************************************************
+ * @fn      pool_free
+ *
+ * @brief   Return a block to pool.
+ *
+ * @return  POOL_ERROR_SUCCESS, or POOL_ERROR if block does not belong
+ *          to pool
+ */
+int pool_free(POOL * pool, void * block)
+{
+    uint32_t offset = (uint32_t)((uint8_t *)block - pool->storage);
+    if((uint8_t *)block < pool->storage || offset >= (uint32_t)pool->block_size * pool->count ||
+       offset % pool->block_size)
+        return POOL_ERROR_ADDRESS;
+
+    uint32_t mstatus = __get_MSTATUS();
+    __disable_irq();
+    int rc = POOL_ERROR_FREE;
+    if(pool->in_use) {
+        ((POOL_BLOCK *)block)->next = pool->free_list;
+        pool->free_list = block;
+        pool->in_use--;
+        rc = POOL_ERROR_SUCCESS;
+    }
+    __set_MSTATUS(mstatus);
+    return rc;
+}
+
+// Allocate from the smallest pool with blocks of at least size bytes
+// Return NULL if that pool is empty or size is too large
+void * pool_get(size_t size)
+{
+    for(unsigned i = 0; i < POOL_COUNT; i++)
+        if(size <= pools[i]->block_size) return pool_alloc(pools[i]);
+    return NULL;
+}
+
+// Free a block allocated by pool_get()
+int pool_put(void * block)
+{
+    for(unsigned i = 0; i < POOL_COUNT; i++) {
+        int rc = pool_free(pools[i], block);
+        if(POOL_ERROR_ADDRESS != rc) return rc;
+    }
+    return POOL_ERROR_ADDRESS;
+}
+
+// pool        -- display pool statistics
+// pool reset  -- free all blocks, clear statistics
+int cl_pool(void)
+{
+    if(argc > 1 && strcmp(argv[1], "reset") == 0)
+        pool_init();
+
+    printf("Pool   Size Count InUse  Peak  Fail\r\n");
+    for(unsigned i = 0; i < POOL_COUNT; i++) {
+        const POOL * p = pools[i];
+        printf("%-6s %4u %5u %5u %5u %5u\r\n", p->name, p->block_size, p->count, p->in_use, p->peak, p->failures);
+    }
+#if MALLOC_DISABLE
+    printf("malloc: disabled\r\n");
+#endif
+    return 0;
+}
@@ -0,0 +1,67 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : pool.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Static fixed-block pool allocator
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_POOL_H_
+#define USER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pool dimensions, sized at compile time.  Block sizes must be multiples of 4.
+// Counts default to 0, no storage: the allocator is available, unused, no
+// module in the tree allocates.  A module that needs blocks raises its
+// count in the build, IE:
+// -DPOOL_SMALL_COUNT=8
+// Small blocks: transaction descriptors, log records
+#ifndef POOL_SMALL_SIZE
+#define POOL_SMALL_SIZE    16
+#endif
+#ifndef POOL_SMALL_COUNT
+#define POOL_SMALL_COUNT   0
+#endif
+// Large blocks: TX buffers
+#ifndef POOL_LARGE_SIZE
+#define POOL_LARGE_SIZE    64
+#endif
+#ifndef POOL_LARGE_COUNT
+#define POOL_LARGE_COUNT   0
+#endif
+
+typedef enum {
+    POOL_ERROR_SUCCESS = 0,
+    POOL_ERROR_ADDRESS = -1,  // not a block of this pool
+    POOL_ERROR_FREE    = -2,  // free with no blocks in use
+} POOL_ERROR;
+
+typedef struct POOL_BLOCK {
+    struct POOL_BLOCK * next;
+} POOL_BLOCK;
+
+typedef struct {
+    const char * name;
+    uint8_t *    storage;
+    POOL_BLOCK * free_list;
+    uint16_t     block_size;
+    uint16_t     count;
+    uint16_t     in_use;
+    uint16_t     peak;      // most blocks in use at once
+    uint16_t     failures;  // allocations refused, pool empty
+} POOL;
+
+extern POOL pool_small;
+extern POOL pool_large;
+
+void pool_init(void);
+void * pool_alloc(POOL * pool);
+int  pool_free(POOL * pool, void * block);
+void * pool_get(size_t size);
+int  pool_put(void * block);
+
+#endif /* USER_POOL_H_ */
@@ -0,0 +1,228 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : power.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : WFI idle, standby with auto wake-up, sleep residency
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Idle: power_idle() replaces the Delay_Ms() busy-wait in the main loop.  The
+  core sleeps (WFI) until the SysTick compare reaches the end of the period,
+  or a byte arrives on USART1 (RXNE interrupt), or any other enabled
+  interrupt fires.  Console input is handled on the next pass, so typing
+  stays responsive.  Both wake interrupts disable themselves, the USART data
+  is still read by polling in cl_loop().  Cycles spent in WFI are counted for
+  the residency report.
+
+  Standby: "sleep <ms>" stops all clocks.  The auto wake-up unit (LSI,
+  EXTI line 9) or a falling edge on USART1 RX (PD6, EXTI line 6) wakes the
+  part, the character that caused the wake is lost.  RAM and registers are
+  kept, execution continues after the WFE.  The core then runs from HSI, so
+  clock_restore() switches back to the clock set by "clock", and reruns the
+  clock callbacks.  SysTick does not count in standby, Millis() does not
+  include time spent there.
+*/
+
+#include <stdlib.h>
+#include "debug.h"
+#include "command_line.h"
+#include "clock.h"
+#include "power.h"
+#include "wdog.h"
+
+void SysTick_Handler(void) __attribute__((interrupt("machine")));
+void USART1_IRQHandler(void) __attribute__((interrupt("machine")));
+
+#define POWER_STIE   (1 << 1)  // SysTick->CTLR compare interrupt enable
+
+volatile POWER_HOOK power_systick_hook;
+
+static uint32_t power_period_start; // SysTick count at start of current idle period
+static uint32_t power_sleep_cycles; // WFI cycles, less than one millisecond
+static uint32_t power_sleep_ms;     // time in WFI since power_window_ms
+static uint32_t power_window_ms;    // Millis() at start of residency window
+static uint32_t power_wakes;
+static volatile uint32_t power_rx_wakes;
+
+// AWU prescaler choices, LSI divided by div
+typedef struct {
+    uint16_t div;
+    uint8_t code;
+} POWER_AWU_PSC;
+
+static const POWER_AWU_PSC power_awu_psc[] = {
+    {1, PWR_AWU_Prescaler_1},       {2, PWR_AWU_Prescaler_2},       {4, PWR_AWU_Prescaler_4},
+    {8, PWR_AWU_Prescaler_8},       {16, PWR_AWU_Prescaler_16},     {32, PWR_AWU_Prescaler_32},
+    {64, PWR_AWU_Prescaler_64},     {128, PWR_AWU_Prescaler_128},   {256, PWR_AWU_Prescaler_256},
+    {512, PWR_AWU_Prescaler_512},   {1024, PWR_AWU_Prescaler_1024}, {2048, PWR_AWU_Prescaler_2048},
+    {4096, PWR_AWU_Prescaler_4096}, {10240, PWR_AWU_Prescaler_10240}, {61440, PWR_AWU_Prescaler_61440},
+};
+
+// SysTick compare, ends an idle sleep, or runs the hook
+// Wake handlers use the standard attribute, they may run with HPE off (lat.c)
+void SysTick_Handler(void)
+{
+    SysTick->SR = 0;
+    if(power_systick_hook)
+        power_systick_hook();
+    else
+        SysTick->CTLR &= ~POWER_STIE;
+}
+
+// Console byte received, wake only, cl_loop() reads the data
+void USART1_IRQHandler(void)
+{
+    USART1->CTLR1 &= ~USART_CTLR1_RXNEIE;
+    power_rx_wakes++;
+}
+
+/*********************************************************************
+ * @fn      power_init
+ *
+ * @brief   Enable the wake interrupts used by power_idle(), start the
+ *          first idle period and residency window.  Call after
+ *          Delay_Init() and USART_Printf_Init().
+ *
+ * @return  none
+ */
+void power_init(void)
+{
+    NVIC_EnableIRQ(SysTicK_IRQn);
+    NVIC_EnableIRQ(USART1_IRQn);
+    power_period_start = SysTick->CNT;
+    power_window_ms = Millis();
+}
+
+/*********************************************************************
+ * @fn      power_idle
+ *
+ * @brief   Sleep until period_ms has elapsed since the previous period
+ *          ended, or an interrupt (console input) wakes the core.
+ *
+ * @param   period_ms - idle period, less than 2^32 SysTick counts
+ *
+ * @return  1 if the period has elapsed, 0 if woken early
+ */
+int power_idle(uint32_t period_ms)
+{
+    uint32_t period = period_ms * (SystemCoreClock / 1000);
+
+    __disable_irq();
+    uint32_t start = SysTick->CNT;
+    if((start - power_period_start) < period && !(USART1->STATR & USART_FLAG_RXNE)) {
+        // Interrupts stay masked across WFI, a pending one still wakes the core
+        SysTick->SR = 0;
+        SysTick->CMP = power_period_start + period;
+        SysTick->CTLR |= POWER_STIE;
+        USART1->CTLR1 |= USART_CTLR1_RXNEIE;
+        __WFI();
+        power_sleep_cycles += SysTick->CNT - start;
+        power_wakes++;
+        // Fold whole milliseconds into power_sleep_ms
+        uint32_t cycles_per_ms = SystemCoreClock / 1000;
+        uint32_t ms = power_sleep_cycles / cycles_per_ms;
+        power_sleep_cycles -= ms * cycles_per_ms;
+        power_sleep_ms += ms;
+    }
+    __enable_irq(); // wake interrupt runs here
+
+    uint32_t now = SysTick->CNT;
+    if((now - power_period_start) < period) return 0;
+    power_period_start += period;
+    if((now - power_period_start) >= period) power_period_start = now; // fell behind, resync
+    return 1;
+}
+
+/*********************************************************************
+ * @fn      power_standby
+ *
+ * @brief   Enter standby for ms milliseconds, or until a falling edge
+ *          on USART1 RX.  Returns after wake-up with the system clock
+ *          restored.
+ *
+ * @param   ms - 1 .. POWER_STANDBY_MAX_MS
+ *
+ * @return  none
+ */
+void power_standby(uint32_t ms)
+{
+    EXTI_InitTypeDef EXTI_InitStructure = {0};
+    uint32_t counts = ms * (POWER_LSI_HZ / 1000);
+    unsigned i;
+
+    // Smallest prescaler that fits the 6-bit window
+    for(i = 0; i < sizeof(power_awu_psc) / sizeof(power_awu_psc[0]) - 1; i++)
+        if(counts / power_awu_psc[i].div <= 0x3F) break;
+    uint32_t window = counts / power_awu_psc[i].div;
+    if(window > 0x3F) window = 0x3F;
+    if(!window) window = 1;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+    RCC_LSICmd(ENABLE);
+    while(RCC_GetFlagStatus(RCC_FLAG_LSIRDY) == RESET);
+
+    // Wake events: AWU on line 9, USART1 RX start bit on line 6
+    EXTI_InitStructure.EXTI_Line = EXTI_Line9;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Event;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+    GPIO_EXTILineConfig(GPIO_PortSourceGPIOD, GPIO_PinSource6);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line6;
+    EXTI_Init(&EXTI_InitStructure);
+
+    PWR_AWU_SetPrescaler(power_awu_psc[i].code);
+    PWR_AWU_SetWindowValue((uint8_t)window);
+    PWR_AutoWakeUpCmd(ENABLE);
+
+    while(USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET); // finish console output
+    PWR_EnterSTANDBYMode(PWR_STANDBYEntry_WFE);
+
+    clock_restore(); // back to the "clock" setting, callbacks included
+    PWR_AutoWakeUpCmd(DISABLE);
+    EXTI_InitStructure.EXTI_LineCmd = DISABLE;
+    EXTI_Init(&EXTI_InitStructure);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line9;
+    EXTI_Init(&EXTI_InitStructure);
+    USART_ClearFlag(USART1, USART_FLAG_RXNE | USART_FLAG_FE | USART_FLAG_NE);
+}
+
+// sleep       -- display WFI residency since the previous report
+// sleep <ms>  -- enter standby for ms, or until console input
+int cl_sleep(void)
+{
+    if(argc > 1) {
+        uint32_t ms = strtoul(argv[1], NULL, 0);
+        if(!ms || ms > POWER_STANDBY_MAX_MS) {
+            printf("Standby time: 1 to %u ms\r\n", POWER_STANDBY_MAX_MS);
+            return 1;
+        }
+        if(wdog_period_ms() && ms > wdog_period_ms()) { // the IWDG runs in standby, at twice the period
+            printf("Standby time: 1 to %u ms with the watchdog on\r\n", wdog_period_ms());
+            return 1;
+        }
+        printf("Standby %u ms\r\n", ms);
+        wdog_kick();
+        power_standby(ms);
+        printf("Awake\r\n");
+        return 0;
+    }
+
+    uint32_t total = Millis() - power_window_ms;
+    uint32_t sleep = power_sleep_ms;
+    while(total > 4000000) { total >>= 1; sleep >>= 1; } // keep sleep * 1000 in 32 bits
+    uint32_t permille = total ? sleep * 1000 / total : 0;
+    printf("Sleep %u of %u ms, residency %u.%u%%, %u wakes, %u by console\r\n", power_sleep_ms,
+           Millis() - power_window_ms, permille / 10, permille % 10, power_wakes, power_rx_wakes);
+
+    power_window_ms = Millis();
+    power_sleep_ms = 0;
+    power_wakes = 0;
+    power_rx_wakes = 0;
+    return 0;
+}
@@ -0,0 +1,29 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : power.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : WFI idle, standby with auto wake-up, sleep residency
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_POWER_H_
+#define USER_POWER_H_
+
+#include "ch32v00x.h"
+
+#define POWER_LSI_HZ         128000  // AWU clock
+#define POWER_STANDBY_MAX_MS 30000   // 63 * 61440 / LSI
+
+typedef void (*POWER_HOOK)(void);
+
+// Called from the SysTick compare interrupt while set, see lat.c.
+// When NULL, the interrupt only ends a power_idle() sleep.
+extern volatile POWER_HOOK power_systick_hook;
+
+void power_init(void);
+int  power_idle(uint32_t period_ms);
+void power_standby(uint32_t ms);
+
+#endif /* USER_POWER_H_ */
@@ -0,0 +1,113 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : prof.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Cycle count profiling using the SysTick counter
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  SysTick is a free running 32-bit counter clocked by HCLK, so a difference of
+  two readings is a count of core cycles, valid for spans up to 2^32 cycles
+  (~89s at 48MHz).  Reading it costs a single load.
+
+  Two kinds of statistics are kept, each with count, min, max and total:
+  - code scopes, PROF_ID, bracketed with PROF_BEGIN()/PROF_END()
+  - commands, recorded by cl_process_buffer() around each command function.
+    PROF_CMD_SLOTS commands have a slot.  A command without one takes the
+    slot with the lowest count, so the most used commands stay, and the
+    executions of the evicted command are counted as not shown.
+
+  Command times include printf() output at the console baud rate.
+*/
+
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "prof.h"
+
+PROF_STAT prof_scopes[PROF_COUNT];
+
+static const char * const prof_names[PROF_COUNT] = {
+    "main loop",
+    "ws2812 fill",
+    "iflash write",
+};
+
+static PROF_STAT prof_commands[PROF_CMD_SLOTS];
+static uint16_t prof_evicted;   // executions of commands that lost their slot
+
+// Accumulate one measurement
+void prof_record(PROF_STAT * stat, uint32_t cycles)
+{
+    if(!stat->count || cycles < stat->min) stat->min = cycles;
+    if(cycles > stat->max) stat->max = cycles;
+    stat->total += cycles;
+    stat->count++;
+}
+
+// Accumulate one command execution time, name is the command table string
+void prof_command(const char * name, uint32_t cycles)
+{
+#if PROF_ENABLE
+    PROF_STAT * victim = &prof_commands[0];
+    for(int i = 0; i < PROF_CMD_SLOTS; i++) {
+        PROF_STAT * stat = &prof_commands[i];
+        if(stat->name == name) {
+            prof_record(stat, cycles);
+            return;
+        }
+        if(stat->count < victim->count) victim = stat; // free slots count 0
+    }
+    prof_evicted += victim->count;
+    memset(victim, 0, sizeof(*victim));
+    victim->name = name;
+    prof_record(victim, cycles);
+#else
+    (void)name;
+    (void)cycles;
+#endif
+}
+
+// Clear all statistics
+void prof_reset(void)
+{
+    memset(prof_scopes, 0, sizeof(prof_scopes));
+    memset(prof_commands, 0, sizeof(prof_commands));
+    prof_evicted = 0;
+}
+
+// Average without a 64-bit divide, total is exact below 2^32 cycles
+static uint32_t prof_average(const PROF_STAT * stat)
+{
+    if(stat->total >> 32) return (uint32_t)(stat->total >> 8) / stat->count << 8;
+    return (uint32_t)stat->total / stat->count;
+}
+
+static void prof_print(const char * name, const PROF_STAT * stat)
+{
+    uint32_t mhz = SystemCoreClock / 1000000;
+    uint32_t avg = prof_average(stat);
+    printf("%-12s %6u %10u %10u %10u %8u\r\n", name, stat->count, stat->min, avg, stat->max, avg / mhz);
+}
+
+// prof        -- display statistics, cycles, and average in microseconds
+// prof reset  -- clear statistics
+int cl_prof(void)
+{
+    if(argc > 1 && strcmp(argv[1], "reset") == 0) {
+        prof_reset();
+        return 0;
+    }
+
+    printf("Scope         Count        Min        Avg        Max   Avg us\r\n");
+    for(int i = 0; i < PROF_COUNT; i++)
+        if(prof_scopes[i].count) prof_print(prof_names[i], &prof_scopes[i]);
+    for(int i = 0; i < PROF_CMD_SLOTS; i++)
+        if(prof_commands[i].count) prof_print(prof_commands[i].name, &prof_commands[i]);
+    if(prof_evicted) printf("%u executions of less used commands not shown\r\n", prof_evicted);
+    return 0;
+}
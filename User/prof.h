@@ -0,0 +1,59 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : prof.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Cycle count profiling using the SysTick counter
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_PROF_H_
+#define USER_PROF_H_
+
+#include "ch32v00x.h"
+
+// 0: scope macros compile to nothing, per-command times are not recorded
+#ifndef PROF_ENABLE
+#define PROF_ENABLE      1
+#endif
+
+// Commands tracked by cl_process_buffer(), the least used gives way, 24 bytes of RAM each
+#ifndef PROF_CMD_SLOTS
+#define PROF_CMD_SLOTS   4
+#endif
+
+// Profiled code scopes, add new IDs before PROF_COUNT and a name in prof.c
+typedef enum {
+    PROF_MAIN_LOOP = 0, // one pass of the main loop, excluding the delay
+    PROF_WS2812_FILL,   // DMA1 channel 3 ISR, encode half a staging buffer
+    PROF_IFLASH_WRITE,  // erase and program one 64 byte page
+    PROF_COUNT
+} PROF_ID;
+
+typedef struct {
+    const char * name;
+    uint32_t count;
+    uint32_t min;       // cycles
+    uint32_t max;       // cycles
+    uint64_t total;     // cycles
+} PROF_STAT;
+
+// SysTick runs free at HCLK, see Delay_Init()
+#define PROF_NOW()  (SysTick->CNT)
+
+#if PROF_ENABLE
+extern PROF_STAT prof_scopes[PROF_COUNT];
+// Bracket a block within one function: PROF_BEGIN(PROF_X); ... PROF_END(PROF_X);
+#define PROF_BEGIN(id)  uint32_t prof_start_##id = PROF_NOW()
+#define PROF_END(id)    prof_record(&prof_scopes[id], PROF_NOW() - prof_start_##id)
+#else
+#define PROF_BEGIN(id)  do {} while(0)
+#define PROF_END(id)    do {} while(0)
+#endif
+
+void prof_record(PROF_STAT * stat, uint32_t cycles);
+void prof_command(const char * name, uint32_t cycles);
+void prof_reset(void);
+
+#endif /* USER_PROF_H_ */
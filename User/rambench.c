@@ -0,0 +1,133 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : rambench.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Compare execution time of code in flash versus RAM
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Each kernel below is compiled twice from the same source, once in flash and
+  once as a RAMFUNC (ramfunc.h).  "rambench [iterations]" runs both copies with
+  interrupts disabled, RB_CHUNK calls at a time with the watchdog fed in
+  between, and reports core clock cycles per call, measured with the free
+  running SysTick (HCLK).
+
+  At 48MHz the flash runs with one wait state, so the difference shows what a
+  loop of that shape gains from RAM.  Use it to decide whether a hot path is
+  worth its RAM.  The kernels read the shared scratch buffer (scratch.h).
+*/
+
+#include <stdlib.h>
+#include "debug.h"
+#include "command_line.h"
+#include "ramfunc.h"
+#include "scratch.h"
+#include "wdog.h"
+
+#define RB_DEFAULT_ITERATIONS  100
+#define RB_BUF_SIZE            64
+#define RB_CHUNK               100     // calls per interrupts-off span, well inside the WWDG's 43 ms
+
+#if RB_BUF_SIZE > SCRATCH_SIZE
+#error "RB_BUF_SIZE: the kernel input must fit the scratch buffer"
+#endif
+
+// Bitwise CRC-16/CCITT: tight, branchy loop, typical of per-byte protocol work
+#define RB_KERNEL_CRC(name, attr)                               \
+static attr uint16_t name(const uint8_t * data, uint32_t count) \
+{                                                               \
+    uint16_t crc = 0xFFFF;                                      \
+    while(count--) {                                            \
+        crc ^= (uint16_t)(*data++) << 8;                        \
+        for(int i = 0; i < 8; i++)                              \
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1; \
+    }                                                           \
+    return crc;                                                 \
+}
+
+// Word sum: load bound, little branching
+#define RB_KERNEL_SUM(name, attr)                               \
+static attr uint32_t name(const uint32_t * data, uint32_t count) \
+{                                                               \
+    uint32_t sum = 0;                                           \
+    while(count--)                                              \
+        sum += *data++;                                         \
+    return sum;                                                 \
+}
+
+RB_KERNEL_CRC(rb_crc_flash, __attribute__((noinline)))
+RB_KERNEL_CRC(rb_crc_ram, RAMFUNC)
+RB_KERNEL_SUM(rb_sum_flash, __attribute__((noinline)))
+RB_KERNEL_SUM(rb_sum_ram, RAMFUNC)
+
+static uint32_t * rb_buf;          // scratch buffer, SCRATCH_RAMBENCH
+static volatile uint32_t rb_sink; // keeps results live
+
+// Return SysTick counts for iterations calls of one kernel
+static uint32_t rb_time_crc(uint16_t (*fn)(const uint8_t *, uint32_t), uint32_t iterations)
+{
+    uint32_t ticks = 0;
+    while(iterations) {
+        uint32_t n = (iterations < RB_CHUNK) ? iterations : RB_CHUNK;
+        __disable_irq();
+        uint32_t start = SysTick->CNT;
+        for(uint32_t i = 0; i < n; i++)
+            rb_sink = fn((const uint8_t *)rb_buf, RB_BUF_SIZE);
+        ticks += SysTick->CNT - start;
+        __enable_irq();
+        wdog_kick(); // iteration count set by the user
+        iterations -= n;
+    }
+    return ticks;
+}
+
+static uint32_t rb_time_sum(uint32_t (*fn)(const uint32_t *, uint32_t), uint32_t iterations)
+{
+    uint32_t ticks = 0;
+    while(iterations) {
+        uint32_t n = (iterations < RB_CHUNK) ? iterations : RB_CHUNK;
+        __disable_irq();
+        uint32_t start = SysTick->CNT;
+        for(uint32_t i = 0; i < n; i++)
+            rb_sink = fn(rb_buf, RB_BUF_SIZE / 4);
+        ticks += SysTick->CNT - start;
+        __enable_irq();
+        wdog_kick(); // iteration count set by the user
+        iterations -= n;
+    }
+    return ticks;
+}
+
+static void rb_report(const char * name, uint32_t flash_ticks, uint32_t ram_ticks, uint32_t iterations)
+{
+    uint32_t flash_cycles = flash_ticks / iterations;
+    uint32_t ram_cycles = ram_ticks / iterations;
+    // Flash time over RAM time, x100
+    uint32_t ratio = ram_cycles ? flash_cycles * 100 / ram_cycles : 0;
+    printf("%-6s flash: %6u  ram: %6u cycles/call  flash/ram: %u.%02u\r\n", name,
+           flash_cycles, ram_cycles, ratio / 100, ratio % 100);
+}
+
+// Run each kernel from flash and from RAM, display cycles per call
+int cl_rambench(void)
+{
+    uint32_t iterations = RB_DEFAULT_ITERATIONS;
+    if(argc > 1) iterations = strtoul(argv[1], NULL, 0);
+    if(!iterations || iterations > 10000) {
+        printf("Iterations: 1 to 10000\r\n");
+        return 1;
+    }
+
+    rb_buf = scratch_take(SCRATCH_RAMBENCH);
+    for(int i = 0; i < RB_BUF_SIZE / 4; i++)
+        rb_buf[i] = 0x9E3779B9UL * (i + 1);
+
+    printf("%u iterations over %u bytes, %u MHz\r\n", iterations, RB_BUF_SIZE, SystemCoreClock / 1000000);
+    rb_report("crc16", rb_time_crc(rb_crc_flash, iterations), rb_time_crc(rb_crc_ram, iterations), iterations);
+    rb_report("sum", rb_time_sum(rb_sum_flash, iterations), rb_time_sum(rb_sum_ram, iterations), iterations);
+    return 0;
+}
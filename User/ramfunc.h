@@ -0,0 +1,24 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ramfunc.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Place selected functions in SRAM
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_RAMFUNC_H_
+#define USER_RAMFUNC_H_
+
+// Functions marked RAMFUNC are linked into .ramfunc (Ld/Link.ld), stored in
+// flash, and copied to SRAM by startup_ch32v00x.S.  They execute without
+// flash wait states, at the cost of RAM for their code.
+//
+// Anything a RAMFUNC calls still runs from flash, including the
+// -msave-restore prologue/epilogue (__riscv_save_N) of non-leaf functions
+// and libgcc helpers such as __mulsi3.  Keep RAM functions small and leaf,
+// and measure with the "rambench" command before spending RAM on one.
+#define RAMFUNC   __attribute__((section(".ramfunc"), noinline))
+
+#endif /* USER_RAMFUNC_H_ */
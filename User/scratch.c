@@ -0,0 +1,39 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : scratch.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Scratch buffer shared by command-only modules
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  The 2K of RAM can't hold a private buffer for every command.  Commands run
+  one at a time from cl_loop(), so modules that only need a buffer while
+  their command runs share this one.  scratch_take() hands the buffer to a
+  new owner, the previous contents are lost.  An owner that keeps data
+  between commands ("la dump") checks scratch_owner() before using it.
+
+  Never take the buffer from an interrupt or a main loop poll task, they run
+  while a command holds it.
+*/
+
+#include "scratch.h"
+
+static uint32_t scratch_buf[SCRATCH_SIZE / 4];  // word aligned for DMA and iflash
+static SCRATCH_OWNER scratch_holder;
+
+// Hand the buffer to owner, return it
+void * scratch_take(SCRATCH_OWNER owner)
+{
+    scratch_holder = owner;
+    return scratch_buf;
+}
+
+// Module that took the buffer last, its data is still there
+SCRATCH_OWNER scratch_owner(void)
+{
+    return scratch_holder;
+}
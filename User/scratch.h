@@ -0,0 +1,32 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : scratch.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Scratch buffer shared by command-only modules
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_SCRATCH_H_
+#define USER_SCRATCH_H_
+
+#include <stdint.h>
+
+#define SCRATCH_SIZE      256     // LA_SAMPLES, one NOR page
+
+// Modules that borrow the buffer, add new owners before SCRATCH_OWNER_COUNT
+typedef enum {
+    SCRATCH_FREE = 0,
+    SCRATCH_LA,             // "la" capture, kept for "la dump"
+    SCRATCH_BENCH,          // "bench" lines and parser output
+    SCRATCH_RAMBENCH,       // "rambench" kernel input
+    SCRATCH_NOR,            // "nor" transfer buffer
+    SCRATCH_KV,             // kv_save() page image
+    SCRATCH_OWNER_COUNT
+} SCRATCH_OWNER;
+
+void *        scratch_take(SCRATCH_OWNER owner);
+SCRATCH_OWNER scratch_owner(void);
+
+#endif /* USER_SCRATCH_H_ */
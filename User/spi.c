@@ -0,0 +1,276 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : spi.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : SPI1 master driver, blocking and DMA full-duplex transfers
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  SPI1 pins (no remap):
+  SCK: PC5, MISO: PC7, MOSI: PC6, CS: PC3 (software controlled, see spi.h)
+
+  DMA1 request mapping:
+  SPI1_RX: Channel 2, SPI1_TX: Channel 3
+
+  DMA transfers are full-duplex.  Both channels are started together, the RX
+  channel's transfer complete interrupt marks the end of the transfer since
+  the last frame received is also the last frame clocked out.
+  For transmit only transfers, received data is discarded into a dummy word.
+  For receive only transfers, 0xFF/0xFFFF is clocked out.
+  spi_wait() allows the transfer its time on the wire, frames * bits at the
+  SPI clock, plus SPI_TIMEOUT_MS.  On a time out both channels are stopped,
+  so the next transfer can start.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "spi.h"
+
+void DMA1_Channel2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
+volatile SPI_CALLBACK spi_dma_rx_hook;
+
+static volatile uint8_t spi_dma_active;
+static SPI_CALLBACK spi_dma_callback;
+static uint16_t spi_dummy; // source/sink for one-directional DMA transfers
+static uint32_t spi_dma_start; // Millis() when the transfer started
+static uint32_t spi_dma_ms;    // allowed for the transfer
+
+/*********************************************************************
+ * @fn      spi_init
+ *
+ * @brief   Initializes SPI1 as master, with software chip select.
+ *
+ * @param   mode - SPI mode 0..3, bit1: CPOL, bit0: CPHA
+ *          prescaler - SPI_BaudRatePrescaler_2 .. SPI_BaudRatePrescaler_256
+ *          datasize - SPI_DataSize_8b or SPI_DataSize_16b
+ *
+ * @return  none
+ */
+void spi_init(uint8_t mode, uint16_t prescaler, uint16_t datasize)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    SPI_InitTypeDef SPI_InitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC | RCC_APB2Periph_SPI1, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    // SCK (PC5), MOSI (PC6)
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_5 | GPIO_Pin_6;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOC, &GPIO_InitStructure);
+
+    // MISO (PC7)
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_7;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_Init(GPIOC, &GPIO_InitStructure);
+
+    // CS, idle high
+    GPIO_SetBits(SPI_CS_PORT, SPI_CS_PIN);
+    GPIO_InitStructure.GPIO_Pin = SPI_CS_PIN;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+    GPIO_Init(SPI_CS_PORT, &GPIO_InitStructure);
+
+    SPI_Cmd(SPI1, DISABLE);
+    SPI_InitStructure.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
+    SPI_InitStructure.SPI_Mode = SPI_Mode_Master;
+    SPI_InitStructure.SPI_DataSize = datasize;
+    SPI_InitStructure.SPI_CPOL = (mode & 2) ? SPI_CPOL_High : SPI_CPOL_Low;
+    SPI_InitStructure.SPI_CPHA = (mode & 1) ? SPI_CPHA_2Edge : SPI_CPHA_1Edge;
+    SPI_InitStructure.SPI_NSS = SPI_NSS_Soft;
+    SPI_InitStructure.SPI_BaudRatePrescaler = prescaler;
+    SPI_InitStructure.SPI_FirstBit = SPI_FirstBit_MSB;
+    SPI_InitStructure.SPI_CRCPolynomial = 7;
+    SPI_Init(SPI1, &SPI_InitStructure);
+    SPI_Cmd(SPI1, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = SPI_DMA_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+// Drive chip select, active low
+void spi_cs(int active)
+{
+    if(active)
+        SPI_CS_PORT->BCR = SPI_CS_PIN;
+    else
+        SPI_CS_PORT->BSHR = SPI_CS_PIN;
+}
+
+// Blocking, send one frame (8 or 16 bits) and return the frame received
+uint16_t spi_transfer(uint16_t data)
+{
+    while(!(SPI1->STATR & SPI_I2S_FLAG_TXE));
+    SPI1->DATAR = data;
+    while(!(SPI1->STATR & SPI_I2S_FLAG_RXNE));
+    return SPI1->DATAR;
+}
+
+// Blocking, 8-bit frames.  Either tx or rx may be NULL.
+void spi_transfer_buf(const uint8_t * tx, uint8_t * rx, uint16_t count)
+{
+    while(count--) {
+        uint8_t data = (uint8_t)spi_transfer(tx ? *tx++ : 0xFF);
+        if(rx) *rx++ = data;
+    }
+}
+
+// Configure one DMA channel for an SPI1 transfer
+static void spi_dma_config(DMA_Channel_TypeDef * channel, uint32_t dir, uint32_t memory, int increment, uint16_t count)
+{
+    DMA_InitTypeDef DMA_InitStructure = {0};
+    int halfword = (SPI1->CTLR1 & SPI_DataSize_16b) != 0;
+
+    DMA_DeInit(channel);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&SPI1->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = memory;
+    DMA_InitStructure.DMA_DIR = dir;
+    DMA_InitStructure.DMA_BufferSize = count;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = increment ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_PeripheralDataSize = halfword ? DMA_PeripheralDataSize_HalfWord : DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = halfword ? DMA_MemoryDataSize_HalfWord : DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(channel, &DMA_InitStructure);
+}
+
+/*********************************************************************
+ * @fn      spi_transfer_dma
+ *
+ * @brief   Start an asynchronous full-duplex DMA transfer.  Caller manages
+ *          chip select.  Buffers must remain valid until the transfer completes.
+ *
+ * @param   tx - data to send, NULL to send 0xFF
+ *          rx - buffer for received data, NULL to discard
+ *          count - number of frames (bytes or half words, per data size)
+ *          callback - called from interrupt context on completion, may be NULL
+ *
+ * @return  SPI_ERROR_SUCCESS or SPI_ERROR_BUSY
+ */
+int spi_transfer_dma(const void * tx, void * rx, uint16_t count, SPI_CALLBACK callback)
+{
+    if(spi_dma_active) return SPI_ERROR_BUSY;
+    if(!count) return SPI_ERROR_SUCCESS;
+
+    spi_dummy = 0xFFFF;
+    spi_dma_config(DMA1_Channel2, DMA_DIR_PeripheralSRC, rx ? (uint32_t)rx : (uint32_t)&spi_dummy, rx != NULL, count);
+    spi_dma_config(DMA1_Channel3, DMA_DIR_PeripheralDST, tx ? (uint32_t)tx : (uint32_t)&spi_dummy, tx != NULL, count);
+    DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, ENABLE);
+
+    // Bits per millisecond at the SPI clock, PCLK / (2 << BR)
+    uint32_t bits = (SPI1->CTLR1 & SPI_DataSize_16b) ? 16 : 8;
+    uint32_t rate = SystemCoreClock / 1000 / (2UL << ((SPI1->CTLR1 & SPI_BaudRatePrescaler_256) >> 3));
+    spi_dma_ms = (uint32_t)count * bits / (rate ? rate : 1) + SPI_TIMEOUT_MS;
+    spi_dma_start = Millis();
+
+    spi_dma_callback = callback;
+    spi_dma_active = 1;
+    (void)SPI1->DATAR; // discard any stale received frame
+
+    DMA_Cmd(DMA1_Channel2, ENABLE);
+    DMA_Cmd(DMA1_Channel3, ENABLE);
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+    return SPI_ERROR_SUCCESS;
+}
+
+// Return non-zero while a DMA transfer is in progress
+int spi_dma_busy(void)
+{
+    return spi_dma_active;
+}
+
+// Stop both DMA channels, the callback is not called
+static void spi_dma_abort(void)
+{
+    DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, DISABLE);
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+    DMA_Cmd(DMA1_Channel2, DISABLE);
+    DMA_Cmd(DMA1_Channel3, DISABLE);
+    DMA_ClearITPendingBit(DMA1_IT_GL2);
+    spi_dma_active = 0;
+}
+
+// Spin, waiting for DMA transfer to complete, abort it after its time out
+// Return SPI_ERROR_SUCCESS or SPI_ERROR_TIME_OUT
+int spi_wait(void)
+{
+    while(spi_dma_active) {
+        if(Millis() - spi_dma_start > spi_dma_ms) {
+            spi_dma_abort();
+            return SPI_ERROR_TIME_OUT;
+        }
+    }
+    return SPI_ERROR_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      DMA1_Channel2_IRQHandler
+ *
+ * @brief   SPI1 RX DMA transfer complete, ends the full-duplex transfer.
+ *          spi_dma_rx_hook takes the interrupt while set.
+ *
+ * @return  none
+ */
+void DMA1_Channel2_IRQHandler(void)
+{
+    SPI_CALLBACK hook = spi_dma_rx_hook;
+    if(hook) {
+        hook();
+        return;
+    }
+    if(DMA_GetITStatus(DMA1_IT_TC2)) {
+        DMA_ClearITPendingBit(DMA1_IT_GL2);
+        SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+        DMA_Cmd(DMA1_Channel2, DISABLE);
+        DMA_Cmd(DMA1_Channel3, DISABLE);
+        spi_dma_active = 0;
+        if(spi_dma_callback) spi_dma_callback();
+    }
+}
+
+// spi init <mode> <divisor> <8|16>  -- configure SPI1
+// spi <byte> [byte] ...             -- raw transfer, CS asserted, display received bytes
+int cl_spi(void)
+{
+    if(strcmp(argv[1], "init") == 0) {
+        if(argc < 5) {
+            printf("Usage: spi init <mode 0-3> <divisor 2-256> <8|16>\r\n");
+            return 1;
+        }
+        uint8_t mode = (uint8_t)strtol(argv[2], NULL, 0) & 3;
+        uint32_t divisor = strtoul(argv[3], NULL, 0);
+        uint16_t prescaler = 0;
+        while((2UL << (prescaler >> 3)) < divisor && prescaler < SPI_BaudRatePrescaler_256)
+            prescaler += SPI_BaudRatePrescaler_4; // step to next power of two
+        uint16_t datasize = (strtol(argv[4], NULL, 0) == 16) ? SPI_DataSize_16b : SPI_DataSize_8b;
+        spi_init(mode, prescaler, datasize);
+        printf("SPI1 mode %u, %u Hz, %s bit\r\n", mode, SystemCoreClock / (2UL << (prescaler >> 3)),
+                datasize == SPI_DataSize_16b ? "16" : "8");
+        return 0;
+    }
+
+    if(!(RCC->APB2PCENR & RCC_APB2Periph_SPI1))
+        spi_init(SPI_DEFAULT_MODE, SPI_DEFAULT_PRESCALER, SPI_DataSize_8b);
+
+    spi_cs(1);
+    for(int i = 1; i < argc; i++) {
+        uint16_t tx = (uint16_t)strtoul(argv[i], NULL, 16);
+        printf("%02X ", spi_transfer(tx));
+    }
+    spi_cs(0);
+    printf("\r\n");
+    return 0;
+}
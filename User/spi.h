@@ -0,0 +1,45 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : spi.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : SPI1 master driver, blocking and DMA full-duplex transfers
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_SPI_H_
+#define USER_SPI_H_
+
+#include "ch32v00x_spi.h"
+
+// Chip select, driven by software (PC1, the hardware NSS pin, is I2C SDA)
+#define SPI_CS_PORT         GPIOC
+#define SPI_CS_PIN          GPIO_Pin_3
+
+#define SPI_DEFAULT_MODE        0
+#define SPI_DEFAULT_PRESCALER   SPI_BaudRatePrescaler_8   // 48MHz / 8 = 6MHz
+#define SPI_TIMEOUT_MS          10    // DMA transfer, on top of its time on the wire
+#define SPI_DMA_PRIORITY        1     // DMA1 channel 2 interrupt, preemption priority
+
+typedef enum {
+    SPI_ERROR_SUCCESS  =  0,
+    SPI_ERROR_BUSY     = -1,  // DMA transfer already in progress
+    SPI_ERROR_TIME_OUT = -2,
+} SPI_ERROR;
+
+typedef void (*SPI_CALLBACK)(void);
+
+// Called from DMA1_Channel2_IRQHandler instead of the SPI handling while
+// set, by another user of the channel with no SPI transfer running, see la.c
+extern volatile SPI_CALLBACK spi_dma_rx_hook;
+
+void     spi_init(uint8_t mode, uint16_t prescaler, uint16_t datasize);
+void     spi_cs(int active);
+uint16_t spi_transfer(uint16_t data);
+void     spi_transfer_buf(const uint8_t * tx, uint8_t * rx, uint16_t count);
+int      spi_transfer_dma(const void * tx, void * rx, uint16_t count, SPI_CALLBACK callback);
+int      spi_dma_busy(void);
+int      spi_wait(void);
+
+#endif /* USER_SPI_H_ */
@@ -0,0 +1,236 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : update.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : In-field firmware update over USART1
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  "update boot" resets into the factory bootloader in the system boot area
+  (SystemReset_StartMode), for use with WCH's ISP tools.
+
+  "update" runs a small updater from RAM, see tools/uart_update.py for the host
+  side.  The updater is linked into .update, which shares its addresses with
+  .bss (Ld/Link.ld).  "update" copies it from flash over .bss, application
+  data is dead by then, so it takes no RAM the rest of the time.  It must not
+  call anything in flash once the first page is erased: no library calls, no
+  multiply (RV32EC uses __mulsi3), no switch tables.  Helpers are forced
+  inline.  The function never returns, so its -msave-restore prologue (a call
+  into flash) runs once, before any erase.  NOCROSSREFS in Link.ld fails the
+  link if it refers to anything in .bss.
+
+  USART1 RX is received by DMA into a ring right after the updater's code.  The host keeps UPD_WINDOW frames in flight, so the
+  link stays busy while pages are programmed with the 64 byte fast page
+  commands, and update time is bounded by link speed.  Frames carry their own
+  block number, so a frame lost to a CRC error is simply resent by the host
+  after a time-out.
+
+  Interrupts stay disabled, the vector table is overwritten with the image.
+  If power fails mid-update, use "update boot" via the factory bootloader,
+  or the WCH-LinkE, to recover.
+*/
+
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "update.h"
+
+#define UPD_RAMFUNC   __attribute__((section(".update"), noinline, noreturn))
+#define UPD_INLINE    static inline __attribute__((always_inline))
+
+// Flash control register bits, from ch32v00x_flash.c
+#define UPD_CR_STRT       0x00000040
+#define UPD_CR_LOCK       0x00000080
+#define UPD_CR_PAGE_PG    0x00010000
+#define UPD_CR_PAGE_ER    0x00020000
+#define UPD_CR_BUF_LOAD   0x00040000
+#define UPD_CR_BUF_RST    0x00080000
+#define UPD_SR_BSY        0x00000001
+#define UPD_KEY1          0x45670123
+#define UPD_KEY2          0xCDEF89AB
+#define UPD_IWDG_RELOAD   0xAAAA      // IWDG_CTLR key, from ch32v00x_iwdg.c
+#define UPD_WWDG_RELOAD   0x7F        // WWDG_CTLR counter, WDOG_WWDG_TOP
+
+#define UPD_RING_MASK     (UPD_RING_SIZE - 1)
+
+UPD_INLINE void upd_flash_wait(void)
+{
+    while(FLASH->STATR & UPD_SR_BSY);
+}
+
+UPD_INLINE uint8_t upd_byte(volatile uint8_t * ring, uint32_t index)
+{
+    return ring[index & UPD_RING_MASK];
+}
+
+UPD_INLINE uint16_t upd_crc_byte(uint16_t crc, uint8_t data)
+{
+    crc ^= (uint16_t)data << 8;
+    for(int i = 0; i < 8; i++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    return crc;
+}
+
+UPD_INLINE void upd_send(uint8_t data)
+{
+    while(!(USART1->STATR & USART_FLAG_TXE));
+    USART1->DATAR = data;
+}
+
+// Erase and program one page from the frame's data field in the ring
+UPD_INLINE void upd_program(volatile uint8_t * ring, uint32_t data_index, uint32_t address)
+{
+    FLASH->CTLR |= UPD_CR_PAGE_ER;
+    FLASH->ADDR = address;
+    FLASH->CTLR |= UPD_CR_STRT;
+    upd_flash_wait();
+    FLASH->CTLR &= ~UPD_CR_PAGE_ER;
+
+    FLASH->CTLR |= UPD_CR_PAGE_PG;
+    FLASH->CTLR |= UPD_CR_BUF_RST;
+    upd_flash_wait();
+    for(uint32_t i = 0; i < UPD_DATA_SIZE; i += 4) {
+        uint32_t word = upd_byte(ring, data_index + i) |
+                ((uint32_t)upd_byte(ring, data_index + i + 1) << 8) |
+                ((uint32_t)upd_byte(ring, data_index + i + 2) << 16) |
+                ((uint32_t)upd_byte(ring, data_index + i + 3) << 24);
+        *(volatile uint32_t *)(address + i) = word;
+        FLASH->CTLR |= UPD_CR_BUF_LOAD;
+        upd_flash_wait();
+    }
+    FLASH->ADDR = address;
+    FLASH->CTLR |= UPD_CR_STRT;
+    upd_flash_wait();
+    FLASH->CTLR &= ~UPD_CR_PAGE_PG;
+}
+
+/*********************************************************************
+ * @fn      update_loop
+ *
+ * @brief   RAM resident frame receiver/programmer.  Never returns,
+ *          ends with a software reset on UPD_CMD_GO.
+ *
+ * @param   ring - DMA receive ring, UPD_RING_SIZE bytes
+ *
+ * @return  none
+ */
+static void UPD_RAMFUNC update_loop(volatile uint8_t * ring)
+{
+    uint32_t tail = 0;
+
+    // Unlock flash, including fast page mode
+    FLASH->KEYR = UPD_KEY1;
+    FLASH->KEYR = UPD_KEY2;
+    FLASH->MODEKEYR = UPD_KEY1;
+    FLASH->MODEKEYR = UPD_KEY2;
+
+    while(1) {
+        IWDG->CTLR = UPD_IWDG_RELOAD; // harmless when the watchdogs are off, see wdog.c
+        WWDG->CTLR = UPD_WWDG_RELOAD; // interrupts are off, the early warning can't refresh it
+        uint32_t head = (UPD_RING_SIZE - DMA1_Channel5->CNTR) & UPD_RING_MASK;
+        uint32_t available = (head - tail) & UPD_RING_MASK;
+
+        if(!available) continue;
+        if(upd_byte(ring, tail) != UPD_SYNC) {
+            tail = (tail + 1) & UPD_RING_MASK; // hunt for sync
+            continue;
+        }
+        if(available < UPD_FRAME_SIZE) continue;
+
+        uint16_t crc = 0xFFFF;
+        for(uint32_t i = 1; i < UPD_FRAME_SIZE - 2; i++)
+            crc = upd_crc_byte(crc, upd_byte(ring, tail + i));
+        uint16_t frame_crc = upd_byte(ring, tail + UPD_FRAME_SIZE - 2) |
+                ((uint16_t)upd_byte(ring, tail + UPD_FRAME_SIZE - 1) << 8);
+        if(crc != frame_crc) {
+            tail = (tail + 1) & UPD_RING_MASK; // corrupt or false sync, host will resend
+            continue;
+        }
+
+        uint8_t cmd = upd_byte(ring, tail + 1);
+        uint8_t block_lo = upd_byte(ring, tail + 2);
+        uint8_t block_hi = upd_byte(ring, tail + 3);
+        uint32_t address = ((uint32_t)block_hi << 14) | ((uint32_t)block_lo << 6); // block * 64
+        uint8_t status = UPD_STATUS_OK;
+
+        if(cmd == UPD_CMD_WRITE) {
+            if(address >= UPD_IMAGE_MAX)
+                status = UPD_STATUS_ADDRESS;
+            else
+                upd_program(ring, tail + 4, FLASH_BASE + address);
+        } else if(cmd == UPD_CMD_VERIFY) {
+            uint32_t length = upd_byte(ring, tail + 4) | ((uint32_t)upd_byte(ring, tail + 5) << 8) |
+                    ((uint32_t)upd_byte(ring, tail + 6) << 16) | ((uint32_t)upd_byte(ring, tail + 7) << 24);
+            uint16_t image_crc = upd_byte(ring, tail + 8) | ((uint16_t)upd_byte(ring, tail + 9) << 8);
+            crc = 0xFFFF;
+            if(length > UPD_IMAGE_MAX) length = 0; // forces a mismatch
+            for(uint32_t i = 0; i < length; i++)
+                crc = upd_crc_byte(crc, *(volatile uint8_t *)(FLASH_BASE + i));
+            if(!length || crc != image_crc) status = UPD_STATUS_VERIFY;
+        }
+
+        upd_send(UPD_SYNC_RSP);
+        upd_send(status);
+        upd_send(block_lo);
+        upd_send(block_hi);
+        tail = (tail + UPD_FRAME_SIZE) & UPD_RING_MASK;
+
+        if(cmd == UPD_CMD_GO) {
+            while(!(USART1->STATR & USART_FLAG_TC));
+            FLASH->CTLR |= UPD_CR_LOCK;
+            PFIC->CFGR = NVIC_KEY3 | 0x80; // software reset
+        }
+    }
+}
+
+// update       -- receive new firmware over USART1
+// update boot  -- reset into factory bootloader (system boot area)
+int cl_update(void)
+{
+    extern uint8_t _update_vma[], _eupdate[], _update_lma[];
+    extern uint8_t _heap_end[];
+    DMA_InitTypeDef DMA_InitStructure = {0};
+
+    if(argc > 1 && strcmp(argv[1], "boot") == 0) {
+        printf("Reset to system boot area\r\n");
+        Delay_Ms(10);
+        SystemReset_StartMode(Start_Mode_BOOT);
+        PFIC->CFGR = NVIC_KEY3 | 0x80;
+        return 0;
+    }
+
+    if(_heap_end - _eupdate < UPD_RING_SIZE) {
+        printf("Not enough RAM for receive ring\r\n");
+        return 1;
+    }
+
+    printf("Updater ready, window %u, ring %u\r\n", UPD_WINDOW, UPD_RING_SIZE);
+    while(USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET);
+
+    __disable_irq();
+    (void)USART1->DATAR; // discard stale byte
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    DMA_DeInit(DMA1_Channel5);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART1->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)_eupdate;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = UPD_RING_SIZE;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel5, &DMA_InitStructure);
+    DMA_Cmd(DMA1_Channel5, ENABLE);
+    USART_DMACmd(USART1, USART_DMAReq_Rx, ENABLE);
+
+    memcpy(_update_vma, _update_lma, (size_t)(_eupdate - _update_vma)); // over .bss, no way back
+    update_loop(_eupdate); // does not return
+}
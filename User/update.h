@@ -0,0 +1,40 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : update.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : In-field firmware update over USART1
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_UPDATE_H_
+#define USER_UPDATE_H_
+
+// Frame, host to device, 70 bytes:
+//   UPD_SYNC, cmd, block (LE16), data[64], CRC16 (LE16) of cmd..data
+// Response, device to host, 4 bytes:
+//   UPD_SYNC_RSP, status, block (LE16)
+#define UPD_SYNC            0xA5
+#define UPD_SYNC_RSP        0x5A
+#define UPD_DATA_SIZE       64
+#define UPD_FRAME_SIZE      (4 + UPD_DATA_SIZE + 2)
+
+// Commands
+#define UPD_CMD_WRITE       'W'   // program data at block * 64
+#define UPD_CMD_VERIFY      'V'   // data: image length (LE32), image CRC16 (LE16)
+#define UPD_CMD_GO          'G'   // reset, run new image
+
+// Status
+#define UPD_STATUS_OK       'K'
+#define UPD_STATUS_ADDRESS  'A'   // block outside firmware area
+#define UPD_STATUS_VERIFY   'E'   // image CRC mismatch
+
+// RX ring, filled by DMA1 channel 5 (USART1_RX), holds UPD_WINDOW frames
+#define UPD_RING_SIZE       256
+#define UPD_WINDOW          3     // frames the host may send ahead of responses
+
+// Firmware area, ends at the event log, see iflash.h
+#define UPD_IMAGE_MAX       0x3C00
+
+#endif /* USER_UPDATE_H_ */
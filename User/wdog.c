@@ -0,0 +1,389 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : wdog.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Watchdog supervisor, per-task check-in, crash snapshots
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  set wdog <ms>    watchdog period, WDOG_MIN_MS to WDOG_MAX_MS, 0: off (default)
+  wdog             period, time since the last feed, culprit of the last reset
+  wdog hang        spin in the console task, test the reset
+  crash            post-mortem of the last stall or fault
+  crash clear
+  crash fault      jump to an invalid address, test the fault handler
+
+  Once started neither watchdog can be stopped, so "set wdog" and "save"
+  take effect at the next reset.
+
+  Supervisor: the main loop brackets each task with wdog_enter() and
+  wdog_checkin().  wdog_poll(), at the end of the loop, feeds only when
+  every task has checked in since the last feed.  A hung task, or a loop
+  that stops calling one, starves the watchdogs.  Feeding bumps wdog_beat.
+
+  The evidence is kept up to date as the loop runs, in a WDOG_NOTE in
+  .noinit RAM (noinit.h):
+    running   task entered and not yet returned
+    missing   tasks that did not check in at the last wdog_poll()
+    command   command being run by the console task, cl_process_buffer()
+  wdog_init() copies the note after a watchdog reset; "resetcause" and
+  "wdog" display it.
+
+  Early warning: the WWDG (HCLK / 4096 / 8, 43 ms from WDOG_WWDG_TOP to the
+  0x40 interrupt at 48 MHz) is refreshed by its own interrupt while
+  wdog_beat moves.  Once the beat has stood still for the period, the
+  interrupt leaves the counter alone and takes a WDOG_CRASH snapshot:
+  mepc is where the stuck code was interrupted, with mcause, sp and the
+  top of the stack.  The WWDG resets one count (0.7 ms) later.
+  HardFault_Handler (ch32v00x_it.c) takes the same snapshot for an
+  exception, then resets.  After the reset wdog_init() logs EVLOG_CRASH
+  once, "crash" displays the snapshot.
+
+  The IWDG (LSI / 128, 1 ms per count) runs at twice the period, a
+  backstop for stalls with interrupts disabled, or inside an interrupt
+  handler of equal or higher priority, where the early warning can't run.
+
+  Commands that legitimately block longer than the period (la capture,
+  servo sweep, ws2812 frames, nor transfers, once per page) call
+  wdog_kick() or wdog_delay_ms() from inside their bounded wait.  Never
+  kick from a loop without an exit.
+  wdog_kick() also refreshes the WWDG counter itself, so it works with
+  interrupts disabled, where the early warning can't run.  Code that masks
+  interrupts must still kick within the 43 ms to the early warning: "bench"
+  and "rambench" time 100 passes at a time, a few ms, and kick between
+  chunks.
+  The IWDG keeps counting in standby, "sleep <ms>" is limited to the
+  period while the watchdog is on; the WWDG stops with HCLK.
+*/
+
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "clock.h"
+#include "evlog.h"
+#include "noinit.h"
+#include "wdog.h"
+
+#define WDOG_ALL      ((uint8_t)((1U << WDOG_TASK_COUNT) - 1))
+#define WDOG_RAM_END  (SRAM_BASE + 2048)
+#define WDOG_EWI_K    (63UL * 4096 * 8 * 1000)  // WWDG counts to the interrupt * prescalers * ms
+
+void WWDG_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
+static const char * const wdog_names[WDOG_TASK_COUNT] = {
+    "console",
+    "nor",
+    "edge",
+    "enc",
+    "rtc",
+};
+
+static NOINIT WDOG_NOTE wdog_note;  // live, survives the reset
+static NOINIT WDOG_CRASH wdog_crash;
+static WDOG_NOTE wdog_last;         // note from before a watchdog reset, magic 0 if none
+static uint16_t wdog_ms;            // period, 0: off
+static uint8_t  wdog_mask;          // tasks checked in since the last feed
+
+// Early warning interrupt
+static volatile uint8_t wdog_beat;  // bumped by each feed
+static uint8_t  wdog_beat_seen;
+static uint16_t wdog_stalls;        // interrupts since the beat last moved
+static uint16_t wdog_stall_limit;   // interrupts in the period
+
+// Power-up leaves random contents, check every field
+static int wdog_note_valid(const WDOG_NOTE * note)
+{
+    if(note->magic != WDOG_MAGIC) return 0;
+    if(note->running != WDOG_TASK_NONE && note->running >= WDOG_TASK_COUNT) return 0;
+    if(note->missing & ~WDOG_ALL) return 0;
+    return memchr(note->command, 0, WDOG_NAME) != NULL;
+}
+
+static int wdog_crash_valid(void)
+{
+    if(wdog_crash.magic != WDOG_CRASH_MAGIC) return 0;
+    if(wdog_crash.source != WDOG_CRASH_WWDG && wdog_crash.source != WDOG_CRASH_FAULT) return 0;
+    if(wdog_crash.task != WDOG_TASK_NONE && wdog_crash.task >= WDOG_TASK_COUNT) return 0;
+    return memchr(wdog_crash.command, 0, WDOG_NAME) != NULL;
+}
+
+/*********************************************************************
+ * @fn      wdog_capture
+ *
+ * @brief   Take a crash snapshot.  Called from WWDG_IRQHandler and
+ *          HardFault_Handler, which reset right after.
+ *
+ * @param   source - WDOG_CRASH_SOURCE
+ *          sp - stack pointer in the handler
+ *
+ * @return  none
+ */
+void wdog_capture(WDOG_CRASH_SOURCE source, uint32_t sp)
+{
+    wdog_crash.magic = WDOG_CRASH_MAGIC;
+    wdog_crash.source = (uint8_t)source;
+    wdog_crash.task = wdog_note.running;
+    wdog_crash.logged = 0;
+    wdog_crash.mepc = __get_MEPC();
+    wdog_crash.mcause = __get_MCAUSE();
+    wdog_crash.sp = sp;
+    wdog_crash.ms = wdog_note.ms;
+    memcpy(wdog_crash.command, wdog_note.command, WDOG_NAME);
+    wdog_crash.command[WDOG_NAME - 1] = 0;
+
+    // A fault may come with a wild sp, read only inside RAM
+    for(int i = 0; i < WDOG_STACK_WORDS; i++) {
+        uint32_t address = sp + (uint32_t)i * 4;
+        int inside = !(sp & 3) && address >= SRAM_BASE && address < WDOG_RAM_END;
+        wdog_crash.stack[i] = inside ? *(volatile uint32_t *)address : 0;
+    }
+}
+
+/*********************************************************************
+ * @fn      WWDG_IRQHandler
+ *
+ * @brief   WWDG early warning, counter at 0x40.  Refresh while the main
+ *          loop is feeding, else take the snapshot and let it reset.
+ *
+ * @return  none
+ */
+void WWDG_IRQHandler(void)
+{
+    WWDG->STATR = 0; // EWIF
+    if(wdog_beat != wdog_beat_seen) {
+        wdog_beat_seen = wdog_beat;
+        wdog_stalls = 0;
+    }
+    if(++wdog_stalls <= wdog_stall_limit) {
+        WWDG->CTLR = WDOG_WWDG_TOP;
+        return;
+    }
+    wdog_capture(WDOG_CRASH_WWDG, __get_SP());
+}
+
+// Clock change callback, keep the stall limit at the period
+static void wdog_clock_update(void)
+{
+    uint32_t ewi_ms = WDOG_EWI_K / SystemCoreClock;
+    uint32_t limit = ewi_ms ? wdog_ms / ewi_ms : wdog_ms;
+
+    wdog_stall_limit = (uint16_t)(limit < 2 ? 2 : limit);
+}
+
+/*********************************************************************
+ * @fn      wdog_init
+ *
+ * @brief   Keep the note of a watchdog reset, log a new crash snapshot,
+ *          start the WWDG early warning and the IWDG backstop.
+ *          Call early, after evlog_init(), before the main loop and
+ *          before anything that may run longer than the period.
+ *
+ * @param   period_ms - 0: off, else WDOG_MIN_MS to WDOG_MAX_MS
+ *
+ * @return  none
+ */
+void wdog_init(uint32_t period_ms)
+{
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    if((RCC->RSTSCKR & (RCC_IWDGRSTF | RCC_WWDGRSTF)) && wdog_note_valid(&wdog_note))
+        wdog_last = wdog_note;
+    if(!wdog_crash_valid())
+        wdog_crash.magic = 0;
+    else if(!wdog_crash.logged) {
+        evlog_event(EVLOG_CRASH, (uint16_t)((wdog_crash.source << 8) | (wdog_crash.mcause & 0xFF)));
+        evlog_flush(); // don't lose evidence to a reset loop
+        wdog_crash.logged = 1;
+    }
+
+    memset(&wdog_note, 0, sizeof(wdog_note));
+    wdog_note.magic = WDOG_MAGIC;
+    wdog_note.running = WDOG_TASK_NONE;
+    wdog_mask = 0;
+
+    if(!period_ms) return;
+    if(period_ms < WDOG_MIN_MS) period_ms = WDOG_MIN_MS;
+    if(period_ms > WDOG_MAX_MS) period_ms = WDOG_MAX_MS;
+    wdog_ms = (uint16_t)period_ms;
+
+    IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+    IWDG_SetPrescaler(IWDG_Prescaler_128);
+    IWDG_SetReload(wdog_ms * 2);
+    IWDG_ReloadCounter();
+    IWDG_Enable();
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_WWDG, ENABLE);
+    WWDG_SetPrescaler(WWDG_Prescaler_8);
+    WWDG_SetWindowValue(WDOG_WWDG_TOP); // no window, refresh at any count
+    wdog_clock_update();
+    clock_register(wdog_clock_update);
+    WWDG_ClearFlag();
+    WWDG_EnableIT();
+    NVIC_InitStructure.NVIC_IRQChannel = WWDG_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+    WWDG_Enable(WDOG_WWDG_TOP);
+}
+
+// Task is about to run
+void wdog_enter(WDOG_TASK task)
+{
+    wdog_note.running = (uint8_t)task;
+}
+
+// Task returned, it is alive
+void wdog_checkin(WDOG_TASK task)
+{
+    wdog_mask |= (uint8_t)(1U << task);
+    wdog_note.running = WDOG_TASK_NONE;
+}
+
+// Feed both watchdogs, unconditionally, also with interrupts disabled
+void wdog_kick(void)
+{
+    if(wdog_ms) {
+        IWDG_ReloadCounter();
+        WWDG->CTLR = WDOG_WWDG_TOP;
+    }
+    wdog_beat++; // the WWDG interrupt keeps refreshing while this moves
+    wdog_note.ms = Millis();
+}
+
+// Called from the main loop after the tasks, feed when all have checked in
+void wdog_poll(void)
+{
+    wdog_note.missing = WDOG_ALL & ~wdog_mask;
+    if(wdog_note.missing) return;
+    wdog_kick();
+    wdog_mask = 0;
+}
+
+// Delay_Ms() that keeps the watchdog fed, for bounded waits in commands
+void wdog_delay_ms(uint32_t ms)
+{
+    while(ms) {
+        uint32_t step = (ms > 100) ? 100 : ms;
+        Delay_Ms(step);
+        wdog_kick();
+        ms -= step;
+    }
+}
+
+// Command the console task is running, NULL when it returns
+void wdog_command(const char * name)
+{
+    if(!name) {
+        wdog_note.command[0] = 0;
+        return;
+    }
+    strncpy(wdog_note.command, name, WDOG_NAME - 1);
+    wdog_note.command[WDOG_NAME - 1] = 0;
+}
+
+// Period in ms, 0 when off
+uint32_t wdog_period_ms(void)
+{
+    return wdog_ms;
+}
+
+// Display the culprit of the last IWDG reset, if any
+void wdog_report(void)
+{
+    if(wdog_last.magic != WDOG_MAGIC) {
+        printf("No watchdog reset recorded\r\n");
+        return;
+    }
+    printf("Watchdog reset, ");
+    if(wdog_last.running != WDOG_TASK_NONE) {
+        printf("stuck in %s", wdog_names[wdog_last.running]);
+        if(wdog_last.command[0]) printf(", command \"%s\"", wdog_last.command);
+    }
+    else if(wdog_last.missing) {
+        printf("tasks not checking in:");
+        for(int t = 0; t < WDOG_TASK_COUNT; t++)
+            if(wdog_last.missing & (1U << t)) printf(" %s", wdog_names[t]);
+    }
+    else
+        printf("main loop stalled outside the tasks");
+    printf(", last fed at %u ms\r\n", wdog_last.ms);
+}
+
+// wdog        -- status, culprit of the last watchdog reset
+// wdog hang   -- spin in the console task until the watchdog resets
+int cl_wdog(void)
+{
+    if(argc > 1 && strcmp(argv[1], "hang") == 0) {
+        if(!wdog_ms) {
+            printf("Watchdog off, set wdog <ms>, save, reset\r\n");
+            return 1;
+        }
+        printf("Hanging, reset in %u ms\r\n", wdog_ms);
+        while(1);
+    }
+    if(argc > 1) {
+        printf("Usage: wdog [hang]\r\n");
+        return 1;
+    }
+
+    if(wdog_ms)
+        printf("Watchdog %u ms, fed %u ms ago\r\n", wdog_ms, Millis() - wdog_note.ms);
+    else
+        printf("Watchdog off, set wdog <ms>, save, reset\r\n");
+    wdog_report();
+    return 0;
+}
+
+static const char * const wdog_causes[] = {
+    "instruction misaligned",
+    "instruction access fault",
+    "illegal instruction",
+    "breakpoint",
+    "load misaligned",
+    "load access fault",
+    "store misaligned",
+    "store access fault",
+};
+
+// crash        -- post-mortem of the last stall or fault
+// crash clear  -- forget it
+// crash fault  -- jump to an invalid address, test the fault handler
+int cl_crash(void)
+{
+    if(argc > 1 && strcmp(argv[1], "clear") == 0) {
+        wdog_crash.magic = 0;
+        return 0;
+    }
+    if(argc > 1 && strcmp(argv[1], "fault") == 0) {
+        printf("Jumping to FFFFFFF0\r\n");
+        ((void (*)(void))0xFFFFFFF0)();
+        return 1;
+    }
+    if(argc > 1) {
+        printf("Usage: crash [clear | fault]\r\n");
+        return 1;
+    }
+    if(!wdog_crash_valid()) {
+        printf("No crash recorded\r\n");
+        return 0;
+    }
+
+    uint32_t cause = wdog_crash.mcause;
+    printf("%s", wdog_crash.source == WDOG_CRASH_WWDG ? "Main loop stall" : "Fault");
+    if(!(cause & 0x80000000) && cause < sizeof(wdog_causes) / sizeof(wdog_causes[0]))
+        printf(", %s", wdog_causes[cause]);
+    if(wdog_crash.task != WDOG_TASK_NONE)
+        printf(", in %s", wdog_names[wdog_crash.task]);
+    if(wdog_crash.command[0])
+        printf(", command \"%s\"", wdog_crash.command);
+    printf(", last fed at %u ms\r\n", wdog_crash.ms);
+    printf("mepc %08X  mcause %08X  sp %08X\r\n", wdog_crash.mepc, cause, wdog_crash.sp);
+    for(int i = 0; i < WDOG_STACK_WORDS; i++)
+        printf("%s%08X%s", (i % 4) ? " " : "  ", wdog_crash.stack[i], (i % 4 == 3) ? "\r\n" : "");
+    return 0;
+}
@@ -0,0 +1,79 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : wdog.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Watchdog supervisor, per-task check-in, crash snapshots
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_WDOG_H_
+#define USER_WDOG_H_
+
+#include <stdint.h>
+
+#define WDOG_MIN_MS       500     // "set wdog" range, the IWDG backstop runs at twice this
+#define WDOG_MAX_MS       2000    // IWDG at LSI / 128, 1 ms per count, 4095 max
+#define WDOG_NAME         12      // command name kept across reset, with NUL
+#define WDOG_MAGIC        0x57444F47  // "WDOG"
+#define WDOG_CRASH_MAGIC  0x43525348  // "CRSH"
+#define WDOG_STACK_WORDS  8       // stack snapshot, words from sp up
+#define WDOG_WWDG_TOP     0x7F    // WWDG counter reload, early warning at 0x40, reset at 0x3F
+
+// Main loop tasks, add new IDs before WDOG_TASK_COUNT and a name in wdog.c.
+// The IWDG is fed only once every task has checked in since the last feed.
+typedef enum {
+    WDOG_TASK_CONSOLE = 0,  // cl_loop(), commands run here
+    WDOG_TASK_NOR,          // nor_poll(), background erase
+    WDOG_TASK_EDGE,         // edge_poll()
+    WDOG_TASK_ENC,          // enc_poll()
+    WDOG_TASK_RTC,          // ds3231_poll(), INT/SQW edges
+    WDOG_TASK_COUNT
+} WDOG_TASK;
+
+#define WDOG_TASK_NONE    0xFF
+
+// Kept in .noinit RAM across a watchdog reset
+typedef struct {
+    uint32_t magic;             // WDOG_MAGIC when valid
+    uint8_t  running;           // task entered and not yet returned, or WDOG_TASK_NONE
+    uint8_t  missing;           // tasks not checked in at the last wdog_poll(), bit per task
+    uint16_t reserved;
+    uint32_t ms;                // Millis() at the last feed
+    char     command[WDOG_NAME]; // command running in WDOG_TASK_CONSOLE, "" if none
+} WDOG_NOTE;
+
+// Source of a crash snapshot
+typedef enum {
+    WDOG_CRASH_WWDG = 1,    // main loop stalled, WWDG early warning interrupt
+    WDOG_CRASH_FAULT,       // exception, HardFault_Handler
+} WDOG_CRASH_SOURCE;
+
+// Kept in .noinit RAM until "crash clear" or the next crash
+typedef struct {
+    uint32_t magic;             // WDOG_CRASH_MAGIC when valid
+    uint8_t  source;            // WDOG_CRASH_SOURCE
+    uint8_t  task;              // WDOG_NOTE running at the time
+    uint8_t  logged;            // EVLOG_CRASH written after the reset
+    uint8_t  reserved;
+    uint32_t mepc;              // fault: faulting instruction, WWDG: where the loop was stuck
+    uint32_t mcause;
+    uint32_t sp;                // in the handler
+    uint32_t ms;                // Millis() at the last feed
+    char     command[WDOG_NAME];
+    uint32_t stack[WDOG_STACK_WORDS];
+} WDOG_CRASH;
+
+void     wdog_init(uint32_t period_ms);
+void     wdog_enter(WDOG_TASK task);
+void     wdog_checkin(WDOG_TASK task);
+void     wdog_poll(void);
+void     wdog_kick(void);
+void     wdog_delay_ms(uint32_t ms);
+void     wdog_command(const char * name);
+uint32_t wdog_period_ms(void);
+void     wdog_report(void);
+void     wdog_capture(WDOG_CRASH_SOURCE source, uint32_t sp);
+
+#endif /* USER_WDOG_H_ */
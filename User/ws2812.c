@@ -0,0 +1,228 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ws2812.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : WS2812 addressable LED strip driver, SPI1 MOSI with DMA
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Data out: PC6 (SPI1 MOSI).  SPI1 is shared with the SPI/NOR drivers, each
+  driver selects its own SPI1 configuration before use.
+
+  No frame buffer.  Pixels are generated on demand by a WS2812_PIXEL source
+  function, encoded into SPI bit patterns in a small staging buffer, and streamed
+  by DMA1 channel 3 in circular mode.  The half transfer and transfer complete
+  interrupts refill the half just sent while the other half goes out, so strip
+  length is not limited by RAM and interrupts stay enabled for the whole frame.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "spi.h"
+#include "ws2812.h"
+#include "prof.h"
+#include "wdog.h"
+
+void DMA1_Channel3_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+
+static uint8_t ws2812_buf[2 * WS2812_HALF_SIZE];
+static uint8_t ws2812_half_zero[2];     // half holds only reset (low) time
+static volatile uint8_t ws2812_active;
+static uint8_t ws2812_zero_sent;
+static uint16_t ws2812_next;            // next pixel to encode
+static uint16_t ws2812_count;
+static WS2812_PIXEL ws2812_source;
+
+// Two WS2812 bits per SPI byte: 00, 01, 10, 11
+static const uint8_t ws2812_pattern[4] = {0x88, 0x8C, 0xC8, 0xCC};
+
+// Encode next chunk of pixels (GRB order, MSB first) into half buffer
+// Return non-zero if the half contains only zeros (reset time)
+static uint8_t ws2812_fill(uint8_t * dst)
+{
+    uint8_t empty = (ws2812_next >= ws2812_count);
+    for(int p = 0; p < WS2812_CHUNK_PIXELS; p++) {
+        if(ws2812_next < ws2812_count) {
+            uint32_t rgb = ws2812_source(ws2812_next++);
+            uint32_t grb = ((rgb & 0x00FF00) << 8) | ((rgb & 0xFF0000) >> 8) | (rgb & 0xFF);
+            for(int shift = 22; shift >= 0; shift -= 2)
+                *dst++ = ws2812_pattern[(grb >> shift) & 3];
+        } else {
+            memset(dst, 0, WS2812_BYTES_PER_PIXEL);
+            dst += WS2812_BYTES_PER_PIXEL;
+        }
+    }
+    return empty;
+}
+
+/*********************************************************************
+ * @fn      ws2812_show
+ *
+ * @brief   Start streaming a frame of count pixels, returns immediately.
+ *
+ * @param   count - number of LEDs
+ *          source - pixel source, called from interrupt context
+ *
+ * @return  0 on success, -1 if a frame is already being sent,
+ *          -2 if HCLK / WS2812_SPI_HZ is not an SPI prescaler (8MHz)
+ */
+int ws2812_show(uint16_t count, WS2812_PIXEL source)
+{
+    DMA_InitTypeDef DMA_InitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    if(ws2812_active) return -1;
+
+    // SPI prescaler for the current clock, 2^(n+1), see clock.c
+    uint32_t div = SystemCoreClock / WS2812_SPI_HZ;
+    uint16_t n;
+    for(n = 0; n < 8 && (2U << n) != div; n++);
+    if(n == 8) return -2;
+    spi_init(0, (uint16_t)(n << 3), SPI_DataSize_8b);
+
+    ws2812_source = source;
+    ws2812_count = count;
+    ws2812_next = 0;
+    ws2812_zero_sent = 0;
+    ws2812_half_zero[0] = ws2812_fill(ws2812_buf);
+    ws2812_half_zero[1] = ws2812_fill(ws2812_buf + WS2812_HALF_SIZE);
+
+    DMA_DeInit(DMA1_Channel3);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&SPI1->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ws2812_buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = sizeof(ws2812_buf);
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel3, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel3, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel3_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    ws2812_active = 1;
+    DMA_Cmd(DMA1_Channel3, ENABLE);
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Tx, ENABLE);
+    return 0;
+}
+
+// Return non-zero while a frame is being sent
+int ws2812_busy(void)
+{
+    return ws2812_active;
+}
+
+/*********************************************************************
+ * @fn      DMA1_Channel3_IRQHandler
+ *
+ * @brief   Half of the staging buffer has been sent, refill it.
+ *          Stop once enough reset (low) time has gone out.
+ *
+ * @return  none
+ */
+void DMA1_Channel3_IRQHandler(void)
+{
+    uint8_t half;
+
+    if(DMA_GetITStatus(DMA1_IT_HT3))
+        half = 0;
+    else if(DMA_GetITStatus(DMA1_IT_TC3))
+        half = 1;
+    else
+        return;
+    DMA_ClearITPendingBit(DMA1_IT_GL3);
+
+    if(ws2812_half_zero[half] && ++ws2812_zero_sent >= WS2812_RESET_HALVES) {
+        SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Tx, DISABLE);
+        DMA_Cmd(DMA1_Channel3, DISABLE);
+        ws2812_active = 0;
+        return;
+    }
+    PROF_BEGIN(PROF_WS2812_FILL);
+    ws2812_half_zero[half] = ws2812_fill(ws2812_buf + half * WS2812_HALF_SIZE);
+    PROF_END(PROF_WS2812_FILL);
+}
+
+// Pattern sources for the command line
+static uint32_t ws2812_color;
+static uint8_t ws2812_offset;
+
+static uint32_t ws2812_fill_source(uint16_t index)
+{
+    (void)index;
+    return ws2812_color;
+}
+
+// Color wheel, hue 0..255 to 0x00RRGGBB
+static uint32_t ws2812_wheel(uint8_t hue)
+{
+    uint8_t r, g, b;
+    if(hue < 85) {
+        r = 255 - hue * 3; g = hue * 3; b = 0;
+    } else if(hue < 170) {
+        hue -= 85; r = 0; g = 255 - hue * 3; b = hue * 3;
+    } else {
+        hue -= 170; r = hue * 3; g = 0; b = 255 - hue * 3;
+    }
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+static uint32_t ws2812_rainbow_source(uint16_t index)
+{
+    return ws2812_wheel((uint8_t)(index * 4 + ws2812_offset));
+}
+
+// led <count> fill <rrggbb>
+// led <count> off
+// led <count> rainbow [frames]
+int cl_led(void)
+{
+    uint16_t count = (uint16_t)strtoul(argv[1], NULL, 0);
+    if(count == 0 || count > WS2812_MAX_PIXELS) {
+        printf("Invalid LED count: %s\r\n", argv[1]);
+        return 1;
+    }
+
+    uint32_t frames = 1;
+    WS2812_PIXEL source = ws2812_fill_source;
+    if(strcmp(argv[2], "fill") == 0) {
+        ws2812_color = (argc > 3) ? strtoul(argv[3], NULL, 16) : 0xFFFFFF;
+    } else if(strcmp(argv[2], "off") == 0) {
+        ws2812_color = 0;
+    } else if(strcmp(argv[2], "rainbow") == 0) {
+        source = ws2812_rainbow_source;
+        frames = (argc > 3) ? strtoul(argv[3], NULL, 0) : 1;
+    } else {
+        printf("Usage: led <count> fill <rrggbb> | off | rainbow [frames]\r\n");
+        return 1;
+    }
+
+    ws2812_offset = 0;
+    while(frames--) {
+        while(ws2812_busy());
+        if(ws2812_show(count, source) == -2) {
+            printf("No %u Hz SPI clock at %u Hz\r\n", WS2812_SPI_HZ, SystemCoreClock);
+            return 1;
+        }
+        ws2812_offset += 2;
+        wdog_kick(); // frame count set by the user
+    }
+    while(ws2812_busy());
+    // Frame time: 24 bits * 1.33us per LED, plus latch
+    printf("%u LEDs, frame time %u us\r\n", count, (uint32_t)count * 32 + WS2812_RESET_HALVES * 128);
+    return 0;
+}
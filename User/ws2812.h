@@ -0,0 +1,31 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ws2812.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : WS2812 addressable LED strip driver, SPI1 MOSI with DMA
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef USER_WS2812_H_
+#define USER_WS2812_H_
+
+#include <stdint.h>
+
+// SPI at 3MHz (48MHz / 16, 24MHz / 8), each WS2812 bit is four SPI bits (1.33us):
+// 0: 1000 (333ns high), 1: 1100 (667ns high)
+#define WS2812_SPI_HZ            3000000
+#define WS2812_BYTES_PER_PIXEL   12     // 24 bits, two WS2812 bits per SPI byte
+#define WS2812_CHUNK_PIXELS      4      // pixels encoded per half buffer
+#define WS2812_HALF_SIZE         (WS2812_CHUNK_PIXELS * WS2812_BYTES_PER_PIXEL)
+#define WS2812_RESET_HALVES      3      // zero halves sent for latch, 3 * 128us > 280us
+#define WS2812_MAX_PIXELS        1000
+
+// Pixel source, return 0x00RRGGBB for the pixel at index.  Called from interrupt context.
+typedef uint32_t (*WS2812_PIXEL)(uint16_t index);
+
+int ws2812_show(uint16_t count, WS2812_PIXEL source);
+int ws2812_busy(void);
+
+#endif /* USER_WS2812_H_ */
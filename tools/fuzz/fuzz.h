@@ -0,0 +1,23 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Command line fuzz targets, shared declarations
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef TOOLS_FUZZ_FUZZ_H_
+#define TOOLS_FUZZ_FUZZ_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// libFuzzer entry point, also called by fuzz_main.c for AFL and replay
+int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size);
+
+// Report a broken invariant and abort, so every fuzzer records a crash
+void fuzz_fail(const char * format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+#endif /* TOOLS_FUZZ_FUZZ_H_ */
@@ -0,0 +1,58 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz_loop.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Fuzz target for cl_loop() console byte streams
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  The input is the byte stream USART_ReadByte() returns, followed by EOF.
+  It runs through the real line editor, parser and command table lookup in
+  User/command_line.c.  Commands are the stubs in fuzz_stubs.c, which
+  check argc and argv; help and add only print and stay real.
+
+  Each input starts with the line editor empty: backspaces clear what the
+  previous input left in the buffer.  Output goes to /dev/null unless
+  FUZZ_VERBOSE is set.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "command_line.h"
+#include "fuzz.h"
+
+static const uint8_t * fuzz_data;
+static size_t fuzz_size;
+
+int USART_ReadByte(void)
+{
+    if(!fuzz_size) return EOF;
+    fuzz_size--;
+    return *fuzz_data++;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+    static const uint8_t clear[MAXSERIALBUF] = {[0 ... MAXSERIALBUF - 1] = _BS};
+    static int quiet = -1;
+
+    if(quiet < 0) {
+        quiet = !getenv("FUZZ_VERBOSE");
+        if(quiet && !freopen("/dev/null", "w", stdout)) quiet = 0;
+    }
+
+    fuzz_data = clear;
+    fuzz_size = sizeof(clear);
+    cl_loop();
+
+    // cl_loop() returns after each line and at EOF
+    fuzz_data = data;
+    fuzz_size = size;
+    while(fuzz_size) cl_loop();
+    cl_loop();
+    return 0;
+}
@@ -0,0 +1,84 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz_main.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Stand-alone driver for the fuzz targets
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Linked instead of libFuzzer's main when building with gcc or for AFL.
+  Each argument is a file (or a directory of files) passed to
+  LLVMFuzzerTestOneInput() once; with no arguments, stdin is.  This
+  replays a corpus or a crash reproducer under the sanitizers, and is the
+  "@@" / stdin harness AFL expects.
+*/
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "fuzz.h"
+
+#define FUZZ_MAX_INPUT  (1 << 20)
+
+static uint8_t fuzz_input[FUZZ_MAX_INPUT];
+
+static void fuzz_run(FILE * f)
+{
+    size_t size = fread(fuzz_input, 1, sizeof(fuzz_input), f);
+    // Exact size copy, reads past the end of the input are reported
+    uint8_t * data = malloc(size ? size : 1);
+    if(!data) abort();
+    memcpy(data, fuzz_input, size);
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+}
+
+static int fuzz_path(const char * path)
+{
+    struct stat st;
+    int count = 0;
+
+    if(stat(path, &st)) {
+        perror(path);
+        exit(1);
+    }
+    if(S_ISDIR(st.st_mode)) {
+        DIR * dir = opendir(path);
+        struct dirent * entry;
+        char name[4096];
+        while(dir && (entry = readdir(dir))) {
+            if(entry->d_name[0] == '.') continue;
+            snprintf(name, sizeof(name), "%s/%s", path, entry->d_name);
+            count += fuzz_path(name);
+        }
+        if(dir) closedir(dir);
+        return count;
+    }
+    FILE * f = fopen(path, "rb");
+    if(!f) {
+        perror(path);
+        exit(1);
+    }
+    fuzz_run(f);
+    fclose(f);
+    return 1;
+}
+
+int main(int argc, char * argv[])
+{
+    int count = 0;
+
+    if(argc < 2) {
+        fuzz_run(stdin);
+        return 0;
+    }
+    for(int i = 1; i < argc; i++) count += fuzz_path(argv[i]);
+    fprintf(stderr, "%s: %d input(s) ok\n", argv[0], count);
+    return 0;
+}
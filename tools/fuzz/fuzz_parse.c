@@ -0,0 +1,56 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz_parse.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Fuzz target for cl_parseArgcArgv()
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Input: one byte selecting the word limit (0..MAXWORDS), then the line.
+  The line and the word array are heap blocks of exactly the size the
+  parser is given, so AddressSanitizer reports any access past either.
+
+  Checked after each parse:
+    - the word count is within the limit
+    - every word starts inside the line, line[length] stays a NUL
+    - words follow each other without overlapping
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "command_line.h"
+#include "fuzz.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size)
+{
+    if(size < 1) return 0;
+    int count = data[0] % (MAXWORDS + 1);
+    const char * text = (const char *)data + 1;
+    size_t length = strnlen(text, size - 1);    // the parser sees a C string
+
+    char * line = malloc(length + 1);
+    char ** words = malloc(count ? count * sizeof(char *) : 1);
+    if(!line || !words) abort();
+    memcpy(line, text, length);
+    line[length] = 0;
+
+    int n = cl_parseArgcArgv(line, words, count);
+    if(n < 0 || n > count) fuzz_fail("word count %d, limit %d", n, count);
+    if(line[length]) fuzz_fail("terminating NUL overwritten");
+
+    const char * end = line; // first byte after the previous word
+    for(int i = 0; i < n; i++) {
+        if(words[i] < end || words[i] > line + length)
+            fuzz_fail("word %d at offset %td, outside the line or overlapping", i, words[i] - line);
+        end = words[i] + strlen(words[i]) + 1;  // NUL at line[length] at the latest
+    }
+
+    free(words);
+    free(line);
+    return 0;
+}
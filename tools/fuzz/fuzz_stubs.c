@@ -0,0 +1,107 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : fuzz_stubs.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Command and hardware stubs for the fuzz targets
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  command_line.c is linked unchanged.  Its table reaches every command, so
+  each one is a stub here that checks what the dispatcher hands it.  The
+  hardware commands defined in command_line.c itself are made weak by the
+  Makefile (objcopy --weaken-symbol), these definitions take their table
+  entries and the originals are dropped by --gc-sections.  PFIC, RCC and
+  SysTick are plain structures, see ../host/include.
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "command_line.h"
+#include "fuzz.h"
+
+PFIC_Type sim_pfic;
+static SysTick_Type fuzz_systick;
+static RCC_TypeDef  fuzz_rcc;
+SysTick_Type * sim_systick_sync(void) { return &fuzz_systick; }
+RCC_TypeDef *  sim_rcc_sync(void)     { return &fuzz_rcc; }
+
+void fuzz_fail(const char * format, ...)
+{
+    va_list args;
+
+    fflush(stdout);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    abort();
+}
+
+void prof_command(const char * name, uint32_t cycles)
+{
+    (void)name;
+    (void)cycles;
+}
+
+void wdog_command(const char * name)
+{
+    (void)name;
+}
+
+// A dispatched command sees 1..MAXWORDS words, each a string inside buffer[]
+static int fuzz_command(void)
+{
+    if(argc < 1 || argc > MAXWORDS) fuzz_fail("argc %d", argc);
+    for(int i = 0; i < argc; i++) {
+        if(argv[i] < buffer || argv[i] >= buffer + MAXSERIALBUF)
+            fuzz_fail("argv[%d] outside buffer", i);
+        if(!memchr(argv[i], 0, buffer + MAXSERIALBUF - argv[i]))
+            fuzz_fail("argv[%d] not terminated", i);
+    }
+    return 0;
+}
+
+#define FUZZ_STUB(name)  int name(void) { return fuzz_command(); }
+// Hardware commands defined in command_line.c, weakened
+FUZZ_STUB(cl_id)
+FUZZ_STUB(cl_info)
+FUZZ_STUB(cl_read)
+FUZZ_STUB(cl_clocks)
+FUZZ_STUB(cl_reset)
+FUZZ_STUB(cl_reset_cause)
+FUZZ_STUB(cl_servo)
+FUZZ_STUB(cl_i2cscan)
+FUZZ_STUB(cl_ds3231_temperature)
+// Other modules
+FUZZ_STUB(cl_vdd)
+FUZZ_STUB(cl_adc)
+FUZZ_STUB(cl_opa)
+FUZZ_STUB(cl_spi)
+FUZZ_STUB(cl_nor)
+FUZZ_STUB(cl_led)
+FUZZ_STUB(cl_set)
+FUZZ_STUB(cl_get)
+FUZZ_STUB(cl_save)
+FUZZ_STUB(cl_log)
+FUZZ_STUB(cl_update)
+FUZZ_STUB(cl_rambench)
+FUZZ_STUB(cl_mem)
+FUZZ_STUB(cl_pool)
+FUZZ_STUB(cl_prof)
+FUZZ_STUB(cl_lat)
+FUZZ_STUB(cl_sleep)
+FUZZ_STUB(cl_clock)
+FUZZ_STUB(cl_bench)
+FUZZ_STUB(cl_la)
+FUZZ_STUB(cl_edge)
+FUZZ_STUB(cl_enc)
+FUZZ_STUB(cl_wdog)
+FUZZ_STUB(cl_crash)
+FUZZ_STUB(cl_rtc)
@@ -0,0 +1,32 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : ch32v00x_conf.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host build, wraps User/ch32v00x_conf.h
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  ch32v00x.h includes this last, after the peripheral pointers are defined.
+  Registers whose status bits depend on what was just written go through a
+  sim.c function, like SysTick in core_riscv.h, so a busy-wait sees the
+  hardware respond on its next read.
+*/
+
+#ifndef __SIM_CH32V00x_CONF_H
+#define __SIM_CH32V00x_CONF_H
+
+#include_next <ch32v00x_conf.h>
+
+extern RCC_TypeDef * sim_rcc_sync(void);  // sim.c, oscillator ready and switch status
+extern SPI_TypeDef * sim_spi_sync(void);  // sim.c, never busy, loopback
+
+#undef  RCC
+#define RCC   (sim_rcc_sync())
+#undef  SPI1
+#define SPI1  (sim_spi_sync())
+
+#endif /* __SIM_CH32V00x_CONF_H */
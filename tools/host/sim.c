@@ -0,0 +1,292 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, memory map, SysTick and RCC models
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  The firmware is compiled for the host and runs against plain memory mapped
+  at the CH32V003 addresses, so every register access in User/ and the
+  StdPeriph drivers works unchanged:
+    0x08000000  16K flash, erased to 0xFF, optionally loaded from / saved to
+                a file (-f) so the key/value store persists between runs
+    0x1FFFF000  electronic signature (flash size, unique ID), option bytes
+    0x40000000  APB1, APB2 and AHB peripherals
+  PFIC and SysTick are ordinary variables, see include/core_riscv.h.
+
+  The hardware side of the register file runs when the firmware touches it:
+  SysTick counts at SystemCoreClock from host time, updated on each access,
+  and the RCC ready and switch status bits follow their enable bits, so
+  SystemInit() and clock_set() complete (include/ch32v00x_conf.h).  ADC calibration and conversions finish as soon as
+  they are started (linker --wrap of the driver functions), conversions use
+  the scriptable voltages below.  USART1, I2C1 and the fast page flash API are replaced by models at
+  the driver level (sim_usart.c, sim_i2c.c, sim_flash.c).  Nothing is ever
+  interrupted, WFI waits for the SysTick compare or console input.
+  SPI reads back what it sends, DMA is not modeled.
+
+  Usage: sim [-f flash.bin] [-t seconds] < script
+  Console input comes from stdin, lines starting with '!' control the
+  models instead of reaching the firmware, see sim_command().
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "debug.h"
+#include "adc.h"
+#include "sim.h"
+
+#define SIM_FLASH_BASE    0x08000000
+#define SIM_FLASH_SIZE    0x4000
+#define SIM_ESIG_BASE     0x1FFFF000
+#define SIM_ESIG_SIZE     0x1000
+#define SIM_PERIPH_SIZE   0x30000
+#define SIM_STIE          (1 << 1)    // SysTick->CTLR compare interrupt enable
+#define SIM_RESET_REQUEST (NVIC_KEY3 | (1 << 7))  // PFIC->CFGR system reset
+#define SIM_MISA          0x40800014  // RV32, E, C, X (vendor extensions)
+
+extern int firmware_main(void);       // User/main.c, built with -Dmain=firmware_main
+
+PFIC_Type    sim_pfic;
+SysTick_Type sim_systick;
+uint32_t     sim_mstatus = 0x1800;    // machine mode, interrupts disabled
+
+uint32_t sim_vdd_mv = ADC_VDD_NOMINAL_MV;
+uint16_t sim_adc_mv[SIM_ADC_CHANNELS];
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const char * sim_flash_file;
+static uint32_t sim_mepc, sim_mcause, sim_mtvec, sim_mscratch;
+
+void sim_lock(void)   { pthread_mutex_lock(&sim_mutex); }
+void sim_unlock(void) { pthread_mutex_unlock(&sim_mutex); }
+
+// Map size bytes of zeroed memory at a fixed target address
+static void * sim_map(uint32_t address, size_t size)
+{
+    void * p = mmap((void *)(uintptr_t)address, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(p == MAP_FAILED || p != (void *)(uintptr_t)address) {
+        fprintf(stderr, "sim: cannot map 0x%08X: %s\n", address, strerror(errno));
+        exit(1);
+    }
+    return p;
+}
+
+static void sim_flash_save(void)
+{
+    if(!sim_flash_file) return;
+    FILE * f = fopen(sim_flash_file, "wb");
+    if(!f || fwrite((void *)(uintptr_t)SIM_FLASH_BASE, SIM_FLASH_SIZE, 1, f) != 1)
+        fprintf(stderr, "sim: cannot write %s\n", sim_flash_file);
+    if(f) fclose(f);
+}
+
+// Flush console output, keep flash contents, leave
+static void sim_exit(int status)
+{
+    fflush(stdout);
+    sim_flash_save();
+    _exit(status);
+}
+
+static void sim_timeout(int sig)
+{
+    (void)sig;
+    fprintf(stderr, "\nsim: time limit reached\n");
+    sim_exit(2);
+}
+
+static void sim_memory_init(void)
+{
+    sim_map(SIM_FLASH_BASE, SIM_FLASH_SIZE);
+    memset((void *)(uintptr_t)SIM_FLASH_BASE, 0xFF, SIM_FLASH_SIZE);
+    if(sim_flash_file) {
+        FILE * f = fopen(sim_flash_file, "rb");
+        if(f) {
+            if(fread((void *)(uintptr_t)SIM_FLASH_BASE, 1, SIM_FLASH_SIZE, f) == 0)
+                fprintf(stderr, "sim: %s is empty\n", sim_flash_file);
+            fclose(f);
+        }
+    }
+
+    uint8_t * esig = sim_map(SIM_ESIG_BASE, SIM_ESIG_SIZE);
+    memset(esig + 0x800, 0xFF, 0x10);              // option bytes, erased
+    *(uint16_t *)(esig + 0x7E0) = SIM_FLASH_SIZE / 1024;
+    for(int i = 0; i < 12; i++)
+        esig[0x7E8 + i] = (uint8_t)(0x51 + i * 0x11); // unique ID
+
+    sim_map(PERIPH_BASE, SIM_PERIPH_SIZE);
+    RCC->CTLR = RCC_HSION;
+    RCC->RSTSCKR = RCC_PORRSTF | RCC_PINRSTF;
+}
+
+// Every SysTick access lands here (include/core_riscv.h), the counter is
+// brought up to date from host time at SystemCoreClock, so reads are exact.
+// A reset requested by writing PFIC->CFGR (cl_reset()) is also taken here,
+// the main loop reads SysTick on every pass.
+SysTick_Type * sim_systick_sync(void)
+{
+    static struct timespec last;
+    static uint64_t remainder;
+    struct timespec now;
+
+    if(sim_pfic.CFGR == SIM_RESET_REQUEST) sim_reset();
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ns = (uint64_t)(now.tv_sec - last.tv_sec) * 1000000000u + now.tv_nsec - last.tv_nsec;
+    last = now;
+    if(sim_systick.CTLR & 1) {
+        uint64_t counts = ns * SystemCoreClock + remainder;
+        remainder = counts % 1000000000u;
+        sim_systick.CNT += (uint32_t)(counts / 1000000000u);
+        if((sim_systick.CTLR & SIM_STIE) && (int32_t)(sim_systick.CNT - sim_systick.CMP) >= 0)
+            sim_systick.SR = 1;
+    }
+    return &sim_systick;
+}
+
+// Oscillators are ready as soon as they are enabled, the clock switch status
+// follows the request, so SystemInit() and clock_set() complete
+RCC_TypeDef * sim_rcc_sync(void)
+{
+    RCC_TypeDef * rcc = (RCC_TypeDef *)RCC_BASE;
+    uint32_t ctlr = rcc->CTLR;
+    uint32_t ready = ((ctlr & RCC_HSION) ? RCC_HSIRDY : 0) | ((ctlr & RCC_HSEON) ? RCC_HSERDY : 0) |
+                     ((ctlr & RCC_PLLON) ? RCC_PLLRDY : 0);
+
+    if((ctlr & (RCC_HSIRDY | RCC_HSERDY | RCC_PLLRDY)) != ready)
+        rcc->CTLR = (ctlr & ~(RCC_HSIRDY | RCC_HSERDY | RCC_PLLRDY)) | ready;
+    uint32_t cfgr0 = rcc->CFGR0;
+    if(((cfgr0 & RCC_SWS) >> 2) != (cfgr0 & RCC_SW))
+        rcc->CFGR0 = (cfgr0 & ~RCC_SWS) | ((cfgr0 & RCC_SW) << 2);
+    if(rcc->RSTSCKR & RCC_LSION)
+        rcc->RSTSCKR |= RCC_LSIRDY;
+    return rcc;
+}
+
+// SPI never busy, received data is what was last sent
+SPI_TypeDef * sim_spi_sync(void)
+{
+    SPI_TypeDef * spi = (SPI_TypeDef *)SPI1_BASE;
+    spi->STATR |= SPI_STATR_TXE | SPI_STATR_RXNE;
+    return spi;
+}
+
+// Calibration completes immediately, the status bits are never set
+void __wrap_ADC_ResetCalibration(ADC_TypeDef * ADCx) { (void)ADCx; }
+void __wrap_ADC_StartCalibration(ADC_TypeDef * ADCx) { (void)ADCx; }
+
+// Conversion completes immediately, result from sim_vdd_mv and sim_adc_mv[]
+void __wrap_ADC_SoftwareStartConvCmd(ADC_TypeDef * ADCx, FunctionalState NewState)
+{
+    if(NewState == DISABLE) return;
+    uint32_t channel = ADCx->RSQR3 & 0x1F;
+    uint32_t mv = (channel == ADC_Channel_Vrefint) ? ADC_VREFINT_MV :
+                  (channel < SIM_ADC_CHANNELS) ? sim_adc_mv[channel] : 0;
+    uint32_t raw = (mv * ADC_FULL_SCALE + sim_vdd_mv / 2) / sim_vdd_mv;
+    ADCx->RDATAR = raw > ADC_FULL_SCALE ? ADC_FULL_SCALE : raw;
+    ADCx->STATR |= ADC_FLAG_EOC;
+}
+
+void sim_wfi(void)
+{
+    fflush(stdout);
+    for(;;) {
+        if(USART1->STATR & USART_FLAG_RXNE) return;
+        if(sim_usart_idle()) sim_exit(0);
+        if(!(SysTick->CTLR & SIM_STIE) || (SysTick->SR & 1)) return;
+        usleep(100);
+    }
+}
+
+void sim_reset(void)
+{
+    printf("sim: system reset\r\n");
+    sim_exit(0);
+}
+
+// "!" lines from the console script, run once the firmware has consumed
+// everything before them and gone idle
+//   !vdd <mV>          supply voltage seen by the ADC
+//   !adc <ch> <mV>     voltage on an ADC channel
+//   !temp <degC>       DS3231 temperature, quarter degree resolution
+//   !sleep <ms>        pause the script
+//   !quit              end the simulation
+void sim_command(char * line)
+{
+    char * argv[8];
+    int argc = 0;
+
+    for(char * tok = strtok(line, " \t\r\n"); tok && argc < 8; tok = strtok(NULL, " \t\r\n"))
+        argv[argc++] = tok;
+    if(!argc) return;
+
+    if(!strcmp(argv[0], "vdd") && argc == 2)
+        sim_vdd_mv = strtoul(argv[1], NULL, 0);
+    else if(!strcmp(argv[0], "adc") && argc == 3 && strtoul(argv[1], NULL, 0) < SIM_ADC_CHANNELS)
+        sim_adc_mv[strtoul(argv[1], NULL, 0)] = (uint16_t)strtoul(argv[2], NULL, 0);
+    else if(!strcmp(argv[0], "sleep") && argc == 2)
+        usleep(strtoul(argv[1], NULL, 0) * 1000);
+    else if(!strcmp(argv[0], "quit"))
+        sim_exit(0);
+    else if(!sim_ds3231_command(argc, argv))
+        fprintf(stderr, "sim: unknown command: !%s\n", argv[0]);
+}
+
+/* Core_Exported_Functions, core_riscv.c on target */
+uint32_t __get_MSTATUS(void)            { return sim_mstatus; }
+void     __set_MSTATUS(uint32_t value)  { sim_mstatus = value; }
+uint32_t __get_MISA(void)               { return SIM_MISA; }
+void     __set_MISA(uint32_t value)     { (void)value; }
+uint32_t __get_MTVEC(void)              { return sim_mtvec; }
+void     __set_MTVEC(uint32_t value)    { sim_mtvec = value; }
+uint32_t __get_MSCRATCH(void)           { return sim_mscratch; }
+void     __set_MSCRATCH(uint32_t value) { sim_mscratch = value; }
+uint32_t __get_MEPC(void)               { return sim_mepc; }
+void     __set_MEPC(uint32_t value)     { sim_mepc = value; }
+uint32_t __get_MCAUSE(void)             { return sim_mcause; }
+void     __set_MCAUSE(uint32_t value)   { sim_mcause = value; }
+uint32_t __get_MVENDORID(void)          { return 0; }
+uint32_t __get_MARCHID(void)            { return 0; }
+uint32_t __get_MIMPID(void)             { return 0; }
+uint32_t __get_MHARTID(void)            { return 0; }
+uint32_t __get_SP(void)                 { return (uint32_t)(uintptr_t)__builtin_frame_address(0); }
+
+int main(int argc, char * argv[])
+{
+    int opt;
+
+    while((opt = getopt(argc, argv, "f:t:")) != -1) {
+        switch(opt) {
+        case 'f':
+            sim_flash_file = optarg;
+            break;
+        case 't':
+            signal(SIGALRM, sim_timeout);
+            alarm(strtoul(optarg, NULL, 0));
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-f flash.bin] [-t seconds] < script\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sim_memory_init();
+    sim_ds3231_init();
+    sim_usart_init();
+
+    SystemInit();
+    return firmware_main();
+}
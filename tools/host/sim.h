@@ -0,0 +1,48 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, register file and device models
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef TOOLS_HOST_SIM_H_
+#define TOOLS_HOST_SIM_H_
+
+#include <stdint.h>
+
+#define SIM_ADC_CHANNELS  10     // A0..A7, Vrefint, Vcalint
+
+// I2C target on the simulated bus, sim_i2c.c
+typedef struct {
+    uint8_t address;                // 7-bit
+    void    (*start)(int read);     // addressed, read or write transfer
+    void    (*write)(uint8_t data);
+    uint8_t (*read)(void);
+    void    (*stop)(void);
+} SIM_I2C_DEVICE;
+
+// sim.c
+extern uint32_t sim_vdd_mv;
+extern uint16_t sim_adc_mv[SIM_ADC_CHANNELS];
+void sim_lock(void);
+void sim_unlock(void);
+
+// sim_usart.c
+void sim_usart_init(void);
+int  sim_usart_idle(void);          // 1 when stdin is exhausted and all input consumed
+int  sim_usart_waiting(void);       // firmware has read all queued input
+
+// sim_i2c.c
+void sim_i2c_attach(const SIM_I2C_DEVICE * device);
+
+// sim_ds3231.c
+void sim_ds3231_init(void);
+int  sim_ds3231_command(int argc, char * argv[]);
+
+// sim.c, "!" lines from the console script
+void sim_command(char * line);
+
+#endif /* TOOLS_HOST_SIM_H_ */
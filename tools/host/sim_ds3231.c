@@ -0,0 +1,182 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_ds3231.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, DS3231 real time clock model
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Register file 0x00..0x12 behind the usual register pointer: the first
+  byte of a write sets the pointer, further bytes are stored, reads
+  auto-increment and wrap.  Time registers (24 hour mode) are loaded from
+  host time plus an offset at the start of each transfer, writing them
+  moves the offset.  Temperature conversions (CONV) finish immediately,
+  the reading comes from "!temp <degC>".
+
+  Alarms set A1F/A2F for every model second that passed since the last
+  transfer and matches the alarm registers (AxMn mask bits, DY/DT).  The
+  INT/SQW pin is not modeled, the flags are seen by reading the status
+  register.  Status flags are cleared by writing 0, BSY is read only.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+
+#define DS3231_ADDRESS   0x68
+#define DS3231_REGS      0x13
+#define DS3231_CONTROL   0x0E
+#define DS3231_STATUS    0x0F
+#define DS3231_TEMP_MSB  0x11
+#define DS3231_TEMP_LSB  0x12
+#define DS3231_CONV      0x20       // control, start temperature conversion
+#define DS3231_ALARM1    0x07
+#define DS3231_ALARM2    0x0B
+#define DS3231_FLAGS     0x83       // OSF, A2F, A1F: write 0 to clear
+#define DS3231_BSY       0x04
+#define DS3231_MASK      0x80       // AxMn, field not compared
+
+static uint8_t ds3231_regs[DS3231_REGS];
+static uint8_t ds3231_pointer;
+static int     ds3231_first;        // next write byte is the register pointer
+static int     ds3231_time_written;
+static time_t  ds3231_offset;       // model time - host time, seconds
+static time_t  ds3231_checked;      // model time alarms were last checked at
+static int     ds3231_temp_q2 = 25 * 4;  // quarter degrees C
+
+static uint8_t ds3231_bcd(int value)     { return (uint8_t)(((value / 10) << 4) | (value % 10)); }
+static int     ds3231_binary(uint8_t bcd) { return (bcd >> 4) * 10 + (bcd & 0x0F); }
+
+// Alarm registers, seconds first (alarm 2 has none, matches at 00)
+static int ds3231_alarm_match(const uint8_t * r, int has_seconds, const struct tm * tm)
+{
+    if(has_seconds) {
+        if(!(r[0] & DS3231_MASK) && ds3231_binary(r[0] & 0x7F) != tm->tm_sec) return 0;
+        r++;
+    }
+    else if(tm->tm_sec) return 0;
+    if(!(r[0] & DS3231_MASK) && ds3231_binary(r[0] & 0x7F) != tm->tm_min) return 0;
+    if(!(r[1] & DS3231_MASK) && ds3231_binary(r[1] & 0x3F) != tm->tm_hour) return 0;
+    if(!(r[2] & DS3231_MASK)) {
+        if(r[2] & 0x40) return (r[2] & 0x0F) == tm->tm_wday + 1; // DY
+        return ds3231_binary(r[2] & 0x3F) == tm->tm_mday;
+    }
+    return 1;
+}
+
+// Flag the alarms for each second since the last check, at most a day
+static void ds3231_alarms(time_t now)
+{
+    time_t t = (now - ds3231_checked > 86400) ? now - 86400 : ds3231_checked;
+    struct tm tm;
+
+    while(t < now) {
+        t++;
+        gmtime_r(&t, &tm);
+        if(ds3231_alarm_match(&ds3231_regs[DS3231_ALARM1], 1, &tm)) ds3231_regs[DS3231_STATUS] |= 0x01;
+        if(ds3231_alarm_match(&ds3231_regs[DS3231_ALARM2], 0, &tm)) ds3231_regs[DS3231_STATUS] |= 0x02;
+    }
+    ds3231_checked = now;
+}
+
+static void ds3231_load(void)
+{
+    time_t now = time(NULL) + ds3231_offset;
+    struct tm tm;
+
+    ds3231_alarms(now);
+    gmtime_r(&now, &tm);
+    ds3231_regs[0] = ds3231_bcd(tm.tm_sec);
+    ds3231_regs[1] = ds3231_bcd(tm.tm_min);
+    ds3231_regs[2] = ds3231_bcd(tm.tm_hour);
+    ds3231_regs[3] = (uint8_t)(tm.tm_wday + 1);
+    ds3231_regs[4] = ds3231_bcd(tm.tm_mday);
+    ds3231_regs[5] = ds3231_bcd(tm.tm_mon + 1) | ((tm.tm_year >= 200) ? 0x80 : 0);
+    ds3231_regs[6] = ds3231_bcd(tm.tm_year % 100);
+    ds3231_regs[DS3231_TEMP_MSB] = (uint8_t)(ds3231_temp_q2 >> 2);
+    ds3231_regs[DS3231_TEMP_LSB] = (uint8_t)((ds3231_temp_q2 & 3) << 6);
+}
+
+// Time registers were written, move the offset to match
+static void ds3231_store(void)
+{
+    struct tm tm = {0};
+    uint8_t hour = ds3231_regs[2];
+
+    tm.tm_sec = ds3231_binary(ds3231_regs[0] & 0x7F);
+    tm.tm_min = ds3231_binary(ds3231_regs[1] & 0x7F);
+    if(hour & 0x40) // 12 hour mode, bit 5 is PM
+        tm.tm_hour = ds3231_binary(hour & 0x1F) % 12 + ((hour & 0x20) ? 12 : 0);
+    else
+        tm.tm_hour = ds3231_binary(hour & 0x3F);
+    tm.tm_mday = ds3231_binary(ds3231_regs[4] & 0x3F);
+    tm.tm_mon = ds3231_binary(ds3231_regs[5] & 0x1F) - 1;
+    tm.tm_year = 100 + ds3231_binary(ds3231_regs[6]) + ((ds3231_regs[5] & 0x80) ? 100 : 0);
+    ds3231_offset = timegm(&tm) - time(NULL);
+    ds3231_checked = time(NULL) + ds3231_offset; // a jump is not an elapsed second
+}
+
+static void ds3231_start(int read)
+{
+    ds3231_load();
+    ds3231_first = !read;
+}
+
+static void ds3231_write(uint8_t data)
+{
+    if(ds3231_first) {
+        ds3231_pointer = data % DS3231_REGS;
+        ds3231_first = 0;
+        return;
+    }
+    if(ds3231_pointer <= 6) ds3231_time_written = 1;
+    if(ds3231_pointer == DS3231_STATUS) {
+        uint8_t old = ds3231_regs[DS3231_STATUS];
+        ds3231_regs[DS3231_STATUS] = (uint8_t)((old & data & DS3231_FLAGS) | (old & DS3231_BSY) |
+                                               (data & ~(DS3231_FLAGS | DS3231_BSY)));
+    }
+    else if(ds3231_pointer != DS3231_TEMP_MSB && ds3231_pointer != DS3231_TEMP_LSB)
+        ds3231_regs[ds3231_pointer] = data;
+    ds3231_pointer = (ds3231_pointer + 1) % DS3231_REGS;
+}
+
+static uint8_t ds3231_read(void)
+{
+    uint8_t data = ds3231_regs[ds3231_pointer];
+    ds3231_pointer = (ds3231_pointer + 1) % DS3231_REGS;
+    return data;
+}
+
+static void ds3231_stop(void)
+{
+    if(ds3231_time_written) ds3231_store();
+    ds3231_time_written = 0;
+    ds3231_regs[DS3231_CONTROL] &= ~DS3231_CONV;
+}
+
+static const SIM_I2C_DEVICE ds3231_device = {
+    DS3231_ADDRESS, ds3231_start, ds3231_write, ds3231_read, ds3231_stop
+};
+
+void sim_ds3231_init(void)
+{
+    ds3231_regs[DS3231_CONTROL] = 0x1C;  // INTCN, RS2, RS1
+    ds3231_regs[DS3231_STATUS] = 0x88;   // OSF, EN32kHz
+    ds3231_checked = time(NULL);
+    sim_i2c_attach(&ds3231_device);
+}
+
+// !temp <degC>, returns 0 if the command is not for this model
+int sim_ds3231_command(int argc, char * argv[])
+{
+    if(strcmp(argv[0], "temp") || argc != 2) return 0;
+    double temp = strtod(argv[1], NULL);
+    ds3231_temp_q2 = (int)(temp * 4 + (temp < 0 ? -0.5 : 0.5));
+    return 1;
+}
@@ -0,0 +1,70 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_flash.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, fast page flash erase/program
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Replaces ch32v00x_flash.c for the functions User/iflash.c calls.  Flash
+  is the memory mapped by sim.c, erase fills a 64 byte page with 0xFF,
+  programming copies the page buffer into place.  Erase or program without
+  FLASH_Unlock_Fast() is reported and ignored.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "debug.h"
+#include "iflash.h"
+
+#define SIM_PAGE_MASK  (~(uint32_t)(IFLASH_PAGE_WORDS * 4 - 1))
+
+static uint32_t sim_page_buffer[IFLASH_PAGE_WORDS];
+static int      sim_fast_unlocked;
+
+void FLASH_Lock(void)
+{
+    FLASH->CTLR |= FLASH_CTLR_LOCK;
+}
+
+void FLASH_Unlock_Fast(void)
+{
+    sim_fast_unlocked = 1;
+}
+
+void FLASH_Lock_Fast(void)
+{
+    sim_fast_unlocked = 0;
+}
+
+void FLASH_BufReset(void)
+{
+    memset(sim_page_buffer, 0xFF, sizeof(sim_page_buffer));
+}
+
+void FLASH_BufLoad(uint32_t Address, uint32_t Data0)
+{
+    sim_page_buffer[(Address & ~SIM_PAGE_MASK) / 4] = Data0;
+}
+
+void FLASH_ErasePage_Fast(uint32_t Page_Address)
+{
+    if(!sim_fast_unlocked) {
+        fprintf(stderr, "sim: flash erase %08X while locked\n", Page_Address);
+        return;
+    }
+    memset((void *)(uintptr_t)(Page_Address & SIM_PAGE_MASK), 0xFF, sizeof(sim_page_buffer));
+}
+
+void FLASH_ProgramPage_Fast(uint32_t Page_Address)
+{
+    if(!sim_fast_unlocked) {
+        fprintf(stderr, "sim: flash program %08X while locked\n", Page_Address);
+        return;
+    }
+    memcpy((void *)(uintptr_t)(Page_Address & SIM_PAGE_MASK), sim_page_buffer, sizeof(sim_page_buffer));
+}
@@ -0,0 +1,157 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_i2c.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, I2C1 master and bus with device models
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Replaces ch32v00x_i2c.c.  User/i2c.c writes bytes to I2C1->DATAR itself,
+  so the model parks DATAR at SIM_I2C_NO_DATA and treats any other value as
+  a byte to send the next time the driver polls for an event.  The first
+  byte after START selects a device from the attached list, an unknown
+  address sets AF (acknowledge failure) the way a real NACK does.  STAR1
+  and STAR2 always hold the current event, so direct register reads agree
+  with I2C_GetLastEvent().
+*/
+
+#include "debug.h"
+#include "sim.h"
+
+#define SIM_I2C_DEVICES  8
+#define SIM_I2C_NO_DATA  0xFFFF     // DATAR is 16 bits wide, written bytes never match
+
+typedef enum {
+    SIM_I2C_IDLE = 0,
+    SIM_I2C_START,      // waiting for the address byte
+    SIM_I2C_TX,
+    SIM_I2C_RX,
+    SIM_I2C_NACK,       // address not acknowledged, waiting for STOP
+} SIM_I2C_STATE;
+
+static const SIM_I2C_DEVICE * sim_i2c_devices[SIM_I2C_DEVICES];
+static const SIM_I2C_DEVICE * sim_i2c_target;
+static SIM_I2C_STATE sim_i2c_state;
+
+void sim_i2c_attach(const SIM_I2C_DEVICE * device)
+{
+    for(int i = 0; i < SIM_I2C_DEVICES; i++) {
+        if(!sim_i2c_devices[i]) {
+            sim_i2c_devices[i] = device;
+            return;
+        }
+    }
+}
+
+static const SIM_I2C_DEVICE * sim_i2c_find(uint8_t address)
+{
+    for(int i = 0; i < SIM_I2C_DEVICES; i++)
+        if(sim_i2c_devices[i] && sim_i2c_devices[i]->address == address)
+            return sim_i2c_devices[i];
+    return NULL;
+}
+
+static void sim_i2c_event(I2C_TypeDef *I2Cx, uint32_t event)
+{
+    I2Cx->STAR1 = (uint16_t)event;
+    I2Cx->STAR2 = (uint16_t)(event >> 16);
+}
+
+// Send a byte the driver wrote to DATAR, if any
+static void sim_i2c_update(I2C_TypeDef *I2Cx)
+{
+    if(sim_i2c_state == SIM_I2C_RX || I2Cx->DATAR == SIM_I2C_NO_DATA) return;
+
+    uint8_t data = (uint8_t)I2Cx->DATAR;
+    I2Cx->DATAR = SIM_I2C_NO_DATA;
+
+    if(sim_i2c_state == SIM_I2C_START) {
+        sim_i2c_target = sim_i2c_find(data >> 1);
+        if(!sim_i2c_target) {
+            sim_i2c_state = SIM_I2C_NACK;
+            sim_i2c_event(I2Cx, 0x00030000 | I2C_STAR1_AF); // BUSY, MSL, AF
+            return;
+        }
+        sim_i2c_target->start(data & 1);
+        sim_i2c_state = (data & 1) ? SIM_I2C_RX : SIM_I2C_TX;
+        sim_i2c_event(I2Cx, (data & 1) ? I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED :
+                                         I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED);
+    }
+    else if(sim_i2c_state == SIM_I2C_TX) {
+        sim_i2c_target->write(data);
+        sim_i2c_event(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED);
+    }
+}
+
+void I2C_DeInit(I2C_TypeDef *I2Cx)
+{
+    I2Cx->CTLR1 = 0;
+    sim_i2c_state = SIM_I2C_IDLE;
+}
+
+void I2C_Init(I2C_TypeDef *I2Cx, I2C_InitTypeDef *I2C_InitStruct)
+{
+    I2Cx->OADDR1 = I2C_InitStruct->I2C_OwnAddress1;
+    I2Cx->DATAR = SIM_I2C_NO_DATA;
+    sim_i2c_event(I2Cx, 0);
+    sim_i2c_state = SIM_I2C_IDLE;
+}
+
+void I2C_Cmd(I2C_TypeDef *I2Cx, FunctionalState NewState)
+{
+    if(NewState != DISABLE)
+        I2Cx->CTLR1 |= I2C_CTLR1_PE;
+    else
+        I2Cx->CTLR1 &= ~I2C_CTLR1_PE;
+}
+
+// START, or repeated START within a transfer
+void I2C_GenerateSTART(I2C_TypeDef *I2Cx, FunctionalState NewState)
+{
+    if(NewState == DISABLE) return;
+    sim_i2c_update(I2Cx);
+    I2Cx->DATAR = SIM_I2C_NO_DATA;
+    sim_i2c_state = SIM_I2C_START;
+    sim_i2c_event(I2Cx, I2C_EVENT_MASTER_MODE_SELECT);
+}
+
+void I2C_GenerateSTOP(I2C_TypeDef *I2Cx, FunctionalState NewState)
+{
+    if(NewState == DISABLE) return;
+    sim_i2c_update(I2Cx);
+    if(sim_i2c_target && (sim_i2c_state == SIM_I2C_TX || sim_i2c_state == SIM_I2C_RX))
+        sim_i2c_target->stop();
+    sim_i2c_target = NULL;
+    sim_i2c_state = SIM_I2C_IDLE;
+    I2Cx->DATAR = SIM_I2C_NO_DATA;
+    sim_i2c_event(I2Cx, I2Cx->STAR1 & I2C_STAR1_AF); // AF stays until software clears it
+}
+
+uint32_t I2C_GetLastEvent(I2C_TypeDef *I2Cx)
+{
+    sim_i2c_update(I2Cx);
+    return ((uint32_t)I2Cx->STAR1 | ((uint32_t)I2Cx->STAR2 << 16)) & 0x00FFFFFF;
+}
+
+// In receive mode, each byte received event clocks in the next byte
+ErrorStatus I2C_CheckEvent(I2C_TypeDef *I2Cx, uint32_t I2C_EVENT)
+{
+    if(sim_i2c_state == SIM_I2C_RX && I2C_EVENT == I2C_EVENT_MASTER_BYTE_RECEIVED) {
+        I2Cx->DATAR = sim_i2c_target->read();
+        sim_i2c_event(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED);
+        return READY;
+    }
+    return ((I2C_GetLastEvent(I2Cx) & I2C_EVENT) == I2C_EVENT) ? READY : NoREADY;
+}
+
+FlagStatus I2C_GetFlagStatus(I2C_TypeDef *I2Cx, uint32_t I2C_FLAG)
+{
+    sim_i2c_update(I2Cx);
+    if(I2C_FLAG >> 28)
+        return (I2Cx->STAR1 & (I2C_FLAG & 0xFFFF)) ? SET : RESET;
+    return (I2Cx->STAR2 & ((I2C_FLAG & 0x00FFFFFF) >> 16)) ? SET : RESET;
+}
@@ -0,0 +1,45 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_stubs.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, stand-ins for target only modules
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  lat.c (CSR access), update.c (runs from RAM, rewrites flash from DMA) and
+  mem.c (linker symbols of the target memory map) are not built for the
+  host.  Their commands report that, the main loop stack check does nothing.
+*/
+
+#include "debug.h"
+#include "command_line.h"
+#include "mem.h"
+
+// Debug/debug.c _sbrk(), glibc supplies malloc() on the host
+char _end[1];
+char _heap_end[1];
+
+static int sim_target_only(void)
+{
+    printf("%s: not available in the simulator\r\n", argv[0]);
+    return 1;
+}
+
+int cl_lat(void)    { return sim_target_only(); }
+int cl_update(void) { return sim_target_only(); }
+int cl_mem(void)    { return sim_target_only(); }
+
+// Stack guard word, 0: intact
+int mem_check(void)
+{
+    return 0;
+}
+
+uint32_t mem_stack_used(void)
+{
+    return 0;
+}
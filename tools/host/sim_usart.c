@@ -0,0 +1,164 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : sim_usart.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : Host simulator, USART1 console on stdin/stdout
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Replaces ch32v00x_usart.c.  A reader thread queues stdin, translating
+  line endings to the CR a terminal sends.  The RXNE bit in USART1->STATR
+  mirrors "queue not empty", so code polling the register directly
+  (power_idle()) sees input too.  The transmitter is always empty, bytes go
+  straight to stdout.  Lines starting with '!' are simulator commands, they
+  run once the firmware has read everything queued before them and is
+  waiting for input again.
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "debug.h"
+#include "sim.h"
+
+#define SIM_RX_SIZE  4096
+
+static uint8_t  sim_rx[SIM_RX_SIZE];
+static uint32_t sim_rx_head, sim_rx_tail;   // head: next write, tail: next read
+static volatile int sim_rx_eof;             // stdin closed
+static volatile int sim_rx_waiting;         // firmware reached WFI with the queue empty
+
+static uint32_t sim_rx_count(void)
+{
+    return sim_rx_head - sim_rx_tail;
+}
+
+// Caller holds sim_lock()
+static void sim_rx_status(void)
+{
+    if(sim_rx_count())
+        USART1->STATR |= USART_FLAG_RXNE;
+    else
+        USART1->STATR &= ~USART_FLAG_RXNE;
+}
+
+static void sim_rx_put(uint8_t c)
+{
+    for(;;) {
+        sim_lock();
+        if(sim_rx_count() < SIM_RX_SIZE) {
+            sim_rx[sim_rx_head++ % SIM_RX_SIZE] = c;
+            sim_rx_waiting = 0;
+            sim_rx_status();
+            sim_unlock();
+            return;
+        }
+        sim_unlock();
+        usleep(1000);
+    }
+}
+
+static void * sim_usart_reader(void * arg)
+{
+    char line[256];
+    (void)arg;
+
+    while(fgets(line, sizeof(line), stdin)) {
+        if(line[0] == '!') {
+            while(!sim_usart_waiting())
+                usleep(1000);
+            sim_command(line + 1);
+            continue;
+        }
+        for(char * p = line; *p; p++) {
+            if(*p == '\r') continue;
+            sim_rx_put(*p == '\n' ? '\r' : (uint8_t)*p);
+        }
+    }
+    sim_rx_eof = 1;
+    return NULL;
+}
+
+void sim_usart_init(void)
+{
+    pthread_t thread;
+
+    USART1->STATR = USART_FLAG_TXE | USART_FLAG_TC;
+    pthread_create(&thread, NULL, sim_usart_reader, NULL);
+}
+
+// Firmware is waiting for input, called from WFI
+int sim_usart_waiting(void)
+{
+    return sim_rx_waiting;
+}
+
+// Called from WFI, returns 1 when the script is finished
+int sim_usart_idle(void)
+{
+    int idle;
+
+    sim_lock();
+    if(!sim_rx_count()) sim_rx_waiting = 1;
+    idle = sim_rx_eof && !sim_rx_count();
+    sim_unlock();
+    return idle;
+}
+
+void USART_DeInit(USART_TypeDef *USARTx)
+{
+    (void)USARTx;
+}
+
+void USART_Init(USART_TypeDef *USARTx, USART_InitTypeDef *USART_InitStruct)
+{
+    USARTx->BRR = (uint16_t)((SystemCoreClock + USART_InitStruct->USART_BaudRate / 2) / USART_InitStruct->USART_BaudRate);
+    USARTx->CTLR1 |= USART_InitStruct->USART_Mode;
+}
+
+void USART_Cmd(USART_TypeDef *USARTx, FunctionalState NewState)
+{
+    if(NewState != DISABLE)
+        USARTx->CTLR1 |= USART_CTLR1_UE;
+    else
+        USARTx->CTLR1 &= ~USART_CTLR1_UE;
+}
+
+void USART_DMACmd(USART_TypeDef *USARTx, uint16_t USART_DMAReq, FunctionalState NewState)
+{
+    (void)USARTx; (void)USART_DMAReq; (void)NewState;
+}
+
+void USART_SendData(USART_TypeDef *USARTx, uint16_t Data)
+{
+    (void)USARTx;
+    putchar(Data & 0xFF);
+}
+
+uint16_t USART_ReceiveData(USART_TypeDef *USARTx)
+{
+    uint16_t data = 0;
+
+    (void)USARTx;
+    sim_lock();
+    if(sim_rx_count())
+        data = sim_rx[sim_rx_tail++ % SIM_RX_SIZE];
+    sim_rx_status();
+    sim_unlock();
+    return data;
+}
+
+FlagStatus USART_GetFlagStatus(USART_TypeDef *USARTx, uint16_t USART_FLAG)
+{
+    return (USARTx->STATR & USART_FLAG) ? SET : RESET;
+}
+
+void USART_ClearFlag(USART_TypeDef *USARTx, uint16_t USART_FLAG)
+{
+    (void)USARTx; (void)USART_FLAG;  // RXNE follows the queue, error flags are never set
+}
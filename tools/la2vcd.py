@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 Jim Merkle
+# SPDX-License-Identifier: Apache-2.0
+#
+# File: la2vcd.py
+#
+# Host side of the CH32V003 command line "la" command, see User/la.c
+#
+# Usage: la2vcd.py [console.log] [capture.vcd]
+# Reads a console log (default stdin) and writes the last capture in it as
+# VCD (default stdout), for sigrok/PulseView or GTKWave:
+#   pulseview -I vcd capture.vcd
+#
+# Capture format, run-length encoded:
+#   LA <port> <rate_hz> <samples> <trigger sample or -1>
+#   <hex value>[x<run length>] ...
+#   END
+
+import sys
+import time
+
+
+def parse(lines):
+    # Return (port, rate, trigger, samples) of the last complete capture
+    capture = None
+    current = None
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "LA" and len(words) == 5:
+            current = (words[1], int(words[2]), int(words[3]), int(words[4]), [])
+        elif current and words[0] == "END":
+            port, rate, count, trigger, samples = current
+            if len(samples) != count:
+                sys.stderr.write("la2vcd: %d samples, header says %d\n" % (len(samples), count))
+            capture = (port, rate, trigger, samples)
+            current = None
+        elif current:
+            for word in words:
+                value, _, run = word.partition("x")
+                current[4].extend([int(value, 16)] * (int(run) if run else 1))
+    if not capture:
+        raise SystemExit("la2vcd: no capture (LA ... END) found")
+    return capture
+
+
+def write_vcd(out, port, rate, trigger, samples):
+    # Sample times rounded to the nearest ns
+    ids = [chr(ord("!") + bit) for bit in range(8)]
+    out.write("$date %s $end\n" % time.strftime("%Y-%m-%d %H:%M:%S"))
+    out.write("$version la2vcd.py $end\n")
+    out.write("$comment P%s0-7 at %u Hz, trigger sample %d $end\n" % (port, rate, trigger))
+    out.write("$timescale 1 ns $end\n")
+    out.write("$scope module P%s $end\n" % port)
+    for bit in range(8):
+        out.write("$var wire 1 %s P%s%u $end\n" % (ids[bit], port, bit))
+    out.write("$var wire 1 T trigger $end\n")
+    out.write("$upscope $end\n$enddefinitions $end\n")
+
+    previous = None
+    for index, value in enumerate(samples):
+        changes = []
+        for bit in range(8):
+            if previous is None or ((value ^ previous) >> bit) & 1:
+                changes.append("%u%s" % ((value >> bit) & 1, ids[bit]))
+        if index == 0:
+            changes.append("%uT" % (trigger == 0))
+        elif index == trigger:
+            changes.append("1T")
+        if changes:
+            out.write("#%u\n%s\n" % (round(index * 1e9 / rate), "\n".join(changes)))
+        previous = value
+    out.write("#%u\n" % round(len(samples) * 1e9 / rate))
+
+
+def main():
+    if len(sys.argv) > 3:
+        raise SystemExit("Usage: la2vcd.py [console.log] [capture.vcd]")
+    source = open(sys.argv[1], errors="replace") if len(sys.argv) > 1 else sys.stdin
+    port, rate, trigger, samples = parse(source)
+    out = open(sys.argv[2], "w") if len(sys.argv) > 2 else sys.stdout
+    write_vcd(out, port, rate, trigger, samples)
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
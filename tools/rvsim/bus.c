@@ -0,0 +1,750 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : bus.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : RV32EC simulator memory map and peripheral models
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Memory follows Ld/Link.ld: 16K flash at 0 (also seen at 0x08000000),
+  2K RAM, the system area with the electronic signature and option bytes,
+  the APB/AHB peripherals and the PFIC/SysTick core block.  Peripherals
+  are plain register storage, with behaviour added where the firmware
+  waits on hardware:
+
+    RCC      oscillator ready and clock switch status follow the enables
+    FLASH    key unlock, fast page erase/program through the page buffer,
+             each operation stalls the core RV_CYCLES_FLASH_PAGE cycles
+    USART1   TX to stdout at the programmed baud rate (TXE/TC timing),
+             RX from the console script, RXNE interrupt
+    ADC1     calibration and conversions complete at once, channel
+             voltages from "!vdd" and "!adc", Vrefint 1200 mV
+    I2C1     master transfers to ../host/sim_ds3231.c, byte times from
+             CKCFGR, absent addresses NACK (AF)
+    SPI1     never busy
+    SysTick  counts from the cycle counter, HCLK or HCLK/8, compare flag
+             and interrupt (up-count, no auto-reload)
+    PFIC     enable/pending registers, system reset through CFGR
+
+  Everything else reads back what was written.  Timers, DMA, EXTI wake
+  and the watchdogs are not modeled.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rvsim.h"
+#include "../host/sim.h"
+
+// Register offsets, ch32v00x.h
+#define RCC_BASE        0x40021000
+#define RCC_CTLR        (RCC_BASE + 0x00)
+#define RCC_CFGR0       (RCC_BASE + 0x04)
+#define RCC_RSTSCKR     (RCC_BASE + 0x24)
+#define FLASH_R_BASE    0x40022000
+#define FLASH_ACTLR     (FLASH_R_BASE + 0x00)
+#define FLASH_KEYR      (FLASH_R_BASE + 0x04)
+#define FLASH_STATR     (FLASH_R_BASE + 0x0C)
+#define FLASH_CTLR      (FLASH_R_BASE + 0x10)
+#define FLASH_ADDR      (FLASH_R_BASE + 0x14)
+#define FLASH_MODEKEYR  (FLASH_R_BASE + 0x24)
+#define USART1_BASE     0x40013800
+#define USART_STATR     (USART1_BASE + 0x00)
+#define USART_DATAR     (USART1_BASE + 0x04)
+#define USART_BRR       (USART1_BASE + 0x08)
+#define USART_CTLR1     (USART1_BASE + 0x0C)
+#define ADC1_BASE       0x40012400
+#define ADC_STATR       (ADC1_BASE + 0x00)
+#define ADC_CTLR2       (ADC1_BASE + 0x08)
+#define ADC_RSQR3       (ADC1_BASE + 0x34)
+#define ADC_RDATAR      (ADC1_BASE + 0x4C)
+#define I2C1_BASE       0x40005400
+#define I2C_CTLR1       (I2C1_BASE + 0x00)
+#define I2C_DATAR       (I2C1_BASE + 0x10)
+#define I2C_STAR1       (I2C1_BASE + 0x14)
+#define I2C_STAR2       (I2C1_BASE + 0x18)
+#define I2C_CKCFGR      (I2C1_BASE + 0x1C)
+#define SPI1_BASE       0x40013000
+#define SPI_STATR       (SPI1_BASE + 0x08)
+#define PFIC_CFGR       (RV_PFIC_BASE + 0x48)
+#define PFIC_IENR       (RV_PFIC_BASE + 0x100)
+#define PFIC_IRER       (RV_PFIC_BASE + 0x180)
+#define PFIC_IPSR       (RV_PFIC_BASE + 0x200)
+#define PFIC_IPRR       (RV_PFIC_BASE + 0x280)
+#define STK_CTLR        (RV_SYSTICK_BASE + 0x00)
+#define STK_SR          (RV_SYSTICK_BASE + 0x04)
+#define STK_CNT         (RV_SYSTICK_BASE + 0x08)
+#define STK_CMP         (RV_SYSTICK_BASE + 0x10)
+
+#define RCC_HSION       (1 << 0)
+#define RCC_HSEON       (1 << 16)
+#define RCC_PLLON       (1 << 24)
+#define RCC_LSION       (1 << 0)
+#define RCC_SFTRSTF     (1u << 28)
+#define RCC_POR_FLAGS   0x0C000000  // PINRSTF | PORRSTF
+#define FLASH_KEY1      0x45670123
+#define FLASH_KEY2      0xCDEF89AB
+#define FLASH_STRT      0x00000040
+#define FLASH_LOCK      0x00000080
+#define FLASH_FLOCK     0x00008000
+#define FLASH_PAGE_PG   0x00010000
+#define FLASH_PAGE_ER   0x00020000
+#define FLASH_BUF_LOAD  0x00040000
+#define FLASH_BUF_RST   0x00080000
+#define FLASH_BSY       0x00000001
+#define FLASH_EOP       0x00000020
+#define FLASH_PAGE      64
+#define USART_RXNE      0x20
+#define USART_TC        0x40
+#define USART_TXE       0x80
+#define ADC_EOC         0x02
+#define ADC_CAL         0x04
+#define ADC_RSTCAL      0x08
+#define ADC_SWSTART     (1 << 22)
+#define I2C_START       0x0100
+#define I2C_STOP        0x0200
+#define I2C_SB          0x0001
+#define I2C_ADDR        0x0002
+#define I2C_BTF         0x0004
+#define I2C_RXNE        0x0040
+#define I2C_TXE         0x0080
+#define I2C_AF          0x0400
+#define I2C_MSL         0x0001
+#define I2C_BUSY        0x0002
+#define I2C_TRA         0x0004
+#define STK_STE         (1 << 0)
+#define STK_STIE        (1 << 1)
+#define STK_STCLK       (1 << 2)
+#define STK_INIT        (1 << 5)
+#define PFIC_RESET      0xBEEF0080  // NVIC_KEY3 | SYSRESET
+
+static uint8_t rv_flash[RV_FLASH_SIZE];
+static uint8_t rv_ram[RV_RAM_SIZE];
+static uint8_t rv_sys[RV_SYS_SIZE];
+static uint8_t rv_periph[RV_PERIPH_SIZE];
+static uint8_t rv_core[2 * RV_CORE_SIZE];    // PFIC, SysTick
+static uint32_t rv_entry;
+
+static uint32_t flash_buffer[FLASH_PAGE / 4];
+static int      flash_keys, flash_mode_keys; // unlock sequence progress
+static uint64_t flash_busy_until;
+
+static uint64_t usart_free_at, usart_done_at; // TXE, TC
+
+typedef enum { I2C_IDLE, I2C_STARTED, I2C_TX, I2C_RX, I2C_NACK } I2C_STATE;
+static I2C_STATE i2c_state;
+static const SIM_I2C_DEVICE * i2c_devices[4];
+static const SIM_I2C_DEVICE * i2c_target;
+static uint16_t i2c_star1, i2c_star2;
+static uint16_t i2c_pending;                 // STAR1 flags set once the byte time elapses
+static uint64_t i2c_ready_at;
+static uint8_t  i2c_rx_data;
+
+static uint32_t stk_count;                   // CNT at stk_base
+static uint64_t stk_base, stk_event;         // cycle, next compare match cycle
+static uint32_t pfic_enabled[2], pfic_pending[2];  // IENR/IRER, IPSR/IPRR
+static uint32_t pfic_ipr[2];                        // software and peripheral pending
+
+uint32_t sim_vdd_mv = 3300;
+uint16_t sim_adc_mv[SIM_ADC_CHANNELS];
+
+#define REG32(mem, offset)  (*(uint32_t *)&(mem)[offset])
+
+static uint32_t * periph(uint32_t address) { return (uint32_t *)&rv_periph[address - RV_PERIPH_BASE]; }
+static uint32_t * core(uint32_t address)   { return (uint32_t *)&rv_core[address - RV_PFIC_BASE]; }
+
+/*
+ * SysTick
+ */
+static uint32_t stk_divider(void)
+{
+    return (*core(STK_CTLR) & STK_STCLK) ? 1 : 8;
+}
+
+static uint32_t stk_now(void)
+{
+    if(!(*core(STK_CTLR) & STK_STE)) return stk_count;
+    return stk_count + (uint32_t)((rv.cycles - stk_base) / stk_divider());
+}
+
+// Restart the count at the current value, then find the next compare match
+static void stk_rebase(uint32_t count)
+{
+    uint64_t wrap = (uint64_t)stk_divider() << 32;
+
+    stk_count = count;
+    stk_base = rv.cycles;
+    stk_event = stk_base + (uint64_t)(uint32_t)(*core(STK_CMP) - count) * stk_divider();
+    if(stk_event < rv.cycles) stk_event += wrap;
+}
+
+static void stk_update(void)
+{
+    if(!(*core(STK_CTLR) & STK_STE) || rv.cycles < stk_event) return;
+    *core(STK_SR) |= 1;
+    stk_event += (uint64_t)stk_divider() << 32;
+}
+
+/*
+ * RCC, hclk for "!sleep"
+ */
+static uint32_t rcc_hclk(void)
+{
+    static const uint16_t div[16] = {1, 2, 3, 4, 5, 6, 7, 8, 2, 4, 8, 16, 64, 128, 256, 512};
+    uint32_t cfgr0 = *periph(RCC_CFGR0);
+    uint32_t sysclk = (cfgr0 & 3) == 2 ? 48000000 : 24000000;    // SW, PLL is 2 x HSI
+
+    return sysclk / div[(cfgr0 >> 4) & 15];
+}
+
+/*
+ * FLASH, fast page mode
+ */
+static void flash_stall(void)
+{
+    flash_busy_until = rv.cycles + RV_CYCLES_FLASH_PAGE;
+    *periph(FLASH_STATR) |= FLASH_BSY;
+}
+
+static void flash_control(uint32_t ctlr)
+{
+    uint32_t page = (*periph(FLASH_ADDR) & (RV_FLASH_SIZE - 1)) & ~(FLASH_PAGE - 1);
+
+    if(ctlr & FLASH_BUF_RST) {
+        memset(flash_buffer, 0xFF, sizeof(flash_buffer));
+        ctlr &= ~FLASH_BUF_RST;
+    }
+    if(ctlr & FLASH_BUF_LOAD) ctlr &= ~FLASH_BUF_LOAD;  // data was stored to the flash address
+    if(ctlr & FLASH_STRT) {
+        ctlr &= ~FLASH_STRT;
+        if(ctlr & (FLASH_LOCK | FLASH_FLOCK))
+            fprintf(stderr, "rvsim: flash %s at %08X while locked, ignored\n",
+                    (ctlr & FLASH_PAGE_ER) ? "erase" : "program", *periph(FLASH_ADDR));
+        else if(ctlr & FLASH_PAGE_ER) {
+            memset(&rv_flash[page], 0xFF, FLASH_PAGE);
+            flash_stall();
+        }
+        else if(ctlr & FLASH_PAGE_PG) {
+            memcpy(&rv_flash[page], flash_buffer, FLASH_PAGE);
+            flash_stall();
+        }
+    }
+    *periph(FLASH_CTLR) = ctlr;
+}
+
+static void flash_key(uint32_t address, uint32_t value)
+{
+    int * progress = (address == FLASH_KEYR) ? &flash_keys : &flash_mode_keys;
+
+    if(*progress == 0 && value == FLASH_KEY1) { *progress = 1; return; }
+    if(*progress == 1 && value == FLASH_KEY2)
+        *periph(FLASH_CTLR) &= (address == FLASH_KEYR) ? ~FLASH_LOCK : ~FLASH_FLOCK;
+    *progress = 0;
+}
+
+/*
+ * USART1
+ */
+static void usart_transmit(uint8_t data)
+{
+    uint64_t frame = 10ull * (*periph(USART_BRR) & 0xFFFF);
+
+    rv_console_tx(data);
+    if(rv.cycles >= usart_done_at) {    // shift register idle, holding register stays empty
+        usart_free_at = rv.cycles;
+        usart_done_at = rv.cycles + frame;
+    }
+    else {
+        usart_free_at = usart_done_at;
+        usart_done_at += frame;
+    }
+}
+
+static uint32_t usart_status(void)
+{
+    uint32_t statr = *periph(USART_STATR) & ~(USART_RXNE | USART_TC | USART_TXE);
+
+    if(rv_console_pending()) statr |= USART_RXNE;
+    if(rv.cycles >= usart_free_at) statr |= USART_TXE;
+    if(rv.cycles >= usart_done_at) statr |= USART_TC;
+    return statr;
+}
+
+/*
+ * ADC1, 10-bit conversions
+ */
+static void adc_control(uint32_t ctlr2)
+{
+    ctlr2 &= ~(ADC_CAL | ADC_RSTCAL);
+    if(ctlr2 & ADC_SWSTART) {
+        uint32_t channel = *periph(ADC_RSQR3) & 0x1F;
+        uint32_t mv = (channel == 8) ? 1200 : (channel < SIM_ADC_CHANNELS) ? sim_adc_mv[channel] : 0;
+        uint32_t raw = sim_vdd_mv ? (mv * 1023 + sim_vdd_mv / 2) / sim_vdd_mv : 0;
+        *periph(ADC_RDATAR) = raw > 1023 ? 1023 : raw;
+        *periph(ADC_STATR) |= ADC_EOC;
+        ctlr2 &= ~ADC_SWSTART;
+    }
+    *periph(ADC_CTLR2) = ctlr2;
+}
+
+/*
+ * I2C1 master
+ */
+void sim_i2c_attach(const SIM_I2C_DEVICE * device)
+{
+    for(unsigned i = 0; i < sizeof(i2c_devices) / sizeof(i2c_devices[0]); i++) {
+        if(!i2c_devices[i]) {
+            i2c_devices[i] = device;
+            return;
+        }
+    }
+}
+
+// Flags appear after a byte time, 9 SCL periods of about 2 * CCR
+static void i2c_after_byte(uint16_t flags)
+{
+    i2c_pending = flags;
+    i2c_ready_at = rv.cycles + 18ull * (*periph(I2C_CKCFGR) & 0xFFF);
+}
+
+static void i2c_update(void)
+{
+    if(i2c_pending && rv.cycles >= i2c_ready_at) {
+        i2c_star1 |= i2c_pending;
+        i2c_pending = 0;
+    }
+}
+
+static void i2c_control(uint32_t ctlr1)
+{
+    if(ctlr1 & I2C_START) {
+        ctlr1 &= ~I2C_START;
+        i2c_state = I2C_STARTED;
+        i2c_star1 &= I2C_AF;
+        i2c_star2 = I2C_MSL | I2C_BUSY;
+        i2c_after_byte(I2C_SB);
+    }
+    if(ctlr1 & I2C_STOP) {
+        ctlr1 &= ~I2C_STOP;
+        if(i2c_target && (i2c_state == I2C_TX || i2c_state == I2C_RX)) i2c_target->stop();
+        i2c_target = NULL;
+        i2c_state = I2C_IDLE;
+        i2c_star1 &= I2C_AF;  // AF stays until software clears it
+        i2c_star2 = 0;
+        i2c_pending = 0;
+    }
+    *periph(I2C_CTLR1) = ctlr1;
+}
+
+static void i2c_write_data(uint8_t data)
+{
+    i2c_update();
+    if(i2c_state == I2C_STARTED) {
+        i2c_star1 &= ~I2C_SB;
+        i2c_target = NULL;
+        for(unsigned i = 0; i < sizeof(i2c_devices) / sizeof(i2c_devices[0]); i++)
+            if(i2c_devices[i] && i2c_devices[i]->address == (data >> 1)) i2c_target = i2c_devices[i];
+        if(!i2c_target) {
+            i2c_state = I2C_NACK;
+            i2c_after_byte(I2C_AF);
+            return;
+        }
+        i2c_target->start(data & 1);
+        i2c_state = (data & 1) ? I2C_RX : I2C_TX;
+        if(data & 1) i2c_after_byte(I2C_ADDR);
+        else {
+            i2c_star2 |= I2C_TRA;
+            i2c_after_byte(I2C_ADDR | I2C_TXE);
+        }
+    }
+    else if(i2c_state == I2C_TX) {
+        i2c_target->write(data);
+        i2c_star1 &= ~(I2C_TXE | I2C_BTF);
+        i2c_after_byte(I2C_TXE | I2C_BTF);
+    }
+}
+
+// STAR1 then STAR2 clears ADDR.  In receive mode the next byte is clocked
+// in once ADDR is clear and DATAR has been read.
+static uint32_t i2c_read_status(uint32_t address)
+{
+    i2c_update();
+    if(address == I2C_STAR1) {
+        if(i2c_state == I2C_RX && !(i2c_star1 & (I2C_ADDR | I2C_RXNE)) && !i2c_pending) {
+            i2c_rx_data = i2c_target->read();
+            i2c_after_byte(I2C_RXNE);
+        }
+        return i2c_star1;
+    }
+    uint32_t star2 = i2c_star2;
+    i2c_star1 &= ~I2C_ADDR;
+    return star2;
+}
+
+/*
+ * PFIC
+ */
+static void pfic_write(uint32_t address, uint32_t value)
+{
+    uint32_t offset = address - RV_PFIC_BASE;
+
+    if(address == PFIC_CFGR && value == PFIC_RESET) {
+        fflush(stdout);
+        memset(rv_periph, 0, sizeof(rv_periph));
+        memset(rv_core, 0, sizeof(rv_core));
+        rv_reset(rv_entry);
+        *periph(RCC_CTLR) = 0x83;
+        *periph(RCC_RSTSCKR) = RCC_SFTRSTF;
+        *periph(FLASH_CTLR) = FLASH_LOCK | FLASH_FLOCK;
+        pfic_enabled[0] = pfic_enabled[1] = pfic_pending[0] = pfic_pending[1] = 0;
+        i2c_state = I2C_IDLE;
+        i2c_star1 = i2c_star2 = i2c_pending = 0;
+        return;
+    }
+    if(offset >= 0x100 && offset < 0x108) pfic_enabled[(offset - 0x100) / 4] |= value;
+    else if(offset >= 0x180 && offset < 0x188) pfic_enabled[(offset - 0x180) / 4] &= ~value;
+    else if(offset >= 0x200 && offset < 0x208) pfic_pending[(offset - 0x200) / 4] |= value;
+    else if(offset >= 0x280 && offset < 0x288) pfic_pending[(offset - 0x280) / 4] &= ~value;
+    else REG32(rv_core, offset) = value;
+}
+
+static uint32_t pfic_read(uint32_t offset)
+{
+    if(offset < 0x08) return pfic_enabled[offset / 4];                  // ISR
+    if(offset >= 0x20 && offset < 0x28) {                               // IPR
+        rv_irq_pending();
+        return pfic_ipr[(offset - 0x20) / 4];
+    }
+    return REG32(rv_core, offset);
+}
+
+/*
+ * Register access.  Offsets within a register are kept so byte and
+ * halfword accesses to 16-bit peripheral registers work.
+ */
+static uint32_t periph_read(uint32_t address, int size)
+{
+    uint32_t reg = address & ~3u, value;
+
+    switch(reg) {
+    case RCC_CTLR: {
+        uint32_t ctlr = *periph(RCC_CTLR);
+        value = ctlr | ((ctlr & (RCC_HSION | RCC_HSEON | RCC_PLLON)) << 1);
+        break;
+    }
+    case RCC_CFGR0: {
+        uint32_t cfgr0 = *periph(RCC_CFGR0);
+        value = (cfgr0 & ~0x0Cu) | ((cfgr0 & 3) << 2);
+        break;
+    }
+    case RCC_RSTSCKR: {
+        uint32_t rstsckr = *periph(RCC_RSTSCKR);
+        value = rstsckr | ((rstsckr & RCC_LSION) << 1);
+        break;
+    }
+    case FLASH_STATR:
+        if(rv.cycles >= flash_busy_until && (*periph(FLASH_STATR) & FLASH_BSY))
+            *periph(FLASH_STATR) = (*periph(FLASH_STATR) & ~FLASH_BSY) | FLASH_EOP;
+        value = *periph(FLASH_STATR);
+        break;
+    case USART_STATR:
+        value = usart_status();
+        break;
+    case USART_DATAR:
+        value = 0;
+        if(!rv_console_rx((uint8_t *)&value)) value = 0;
+        break;
+    case ADC_RDATAR:
+        *periph(ADC_STATR) &= ~ADC_EOC;
+        value = *periph(ADC_RDATAR);
+        break;
+    case I2C_STAR1:
+    case I2C_STAR2:
+        value = i2c_read_status(reg);
+        break;
+    case I2C_DATAR:
+        i2c_star1 &= ~I2C_RXNE;
+        value = i2c_rx_data;
+        break;
+    case SPI_STATR:
+        value = *periph(SPI_STATR) | 0x03;  // TXE | RXNE
+        break;
+    default:
+        value = *periph(reg);
+    }
+    value >>= (address & 3) * 8;
+    return size == 4 ? value : value & ((1u << (size * 8)) - 1);
+}
+
+static void periph_write(uint32_t address, uint32_t value, int size)
+{
+    uint32_t reg = address & ~3u;
+
+    if(size < 4) {  // merge into the register
+        uint32_t shift = (address & 3) * 8, mask = ((1u << (size * 8)) - 1) << shift;
+        value = (*periph(reg) & ~mask) | ((value << shift) & mask);
+    }
+    switch(reg) {
+    case FLASH_KEYR:
+    case FLASH_MODEKEYR:
+        flash_key(reg, value);
+        break;
+    case FLASH_CTLR:
+        flash_control(value);
+        break;
+    case FLASH_STATR:
+        *periph(reg) &= ~(value & FLASH_EOP);  // write 1 to clear
+        break;
+    case USART_DATAR:
+        usart_transmit((uint8_t)value);
+        break;
+    case USART_STATR:
+        *periph(reg) = value;
+        break;
+    case ADC_CTLR2:
+        adc_control(value);
+        break;
+    case I2C_CTLR1:
+        i2c_control(value);
+        break;
+    case I2C_DATAR:
+        i2c_write_data((uint8_t)value);
+        break;
+    case I2C_STAR1:
+        i2c_star1 &= value | ~I2C_AF;  // error flags are cleared by writing 0
+        break;
+    default:
+        *periph(reg) = value;
+    }
+}
+
+static uint32_t core_read(uint32_t address)
+{
+    if(address < RV_SYSTICK_BASE) return pfic_read(address - RV_PFIC_BASE);
+    switch(address) {
+    case STK_CNT: return stk_now();
+    case STK_SR:  stk_update(); return *core(STK_SR);
+    default:      return *core(address);
+    }
+}
+
+static void core_write(uint32_t address, uint32_t value)
+{
+    if(address < RV_SYSTICK_BASE) {
+        pfic_write(address, value);
+        return;
+    }
+    uint32_t count = stk_now();
+    switch(address) {
+    case STK_CTLR:
+        if(value & STK_INIT) count = 0;
+        *core(STK_CTLR) = value & ~STK_INIT;
+        break;
+    case STK_CNT:
+        count = value;
+        break;
+    case STK_SR:
+        stk_update();
+        *core(STK_SR) = value;
+        return;
+    default:
+        *core(address) = value;
+    }
+    stk_rebase(count);
+}
+
+static uint8_t * rv_memory(uint32_t address, int size)
+{
+    if(address < RV_FLASH_SIZE) return &rv_flash[address];
+    if(address - RV_FLASH_ALIAS < RV_FLASH_SIZE) return &rv_flash[address - RV_FLASH_ALIAS];
+    if(address - RV_RAM_BASE < RV_RAM_SIZE) return &rv_ram[address - RV_RAM_BASE];
+    if(address - RV_SYS_BASE < RV_SYS_SIZE) return &rv_sys[address - RV_SYS_BASE];
+    (void)size;
+    return NULL;
+}
+
+int rv_is_flash(uint32_t address)
+{
+    return address < RV_FLASH_SIZE || address - RV_FLASH_ALIAS < RV_FLASH_SIZE;
+}
+
+int rv_flash_wait_states(void)
+{
+    return *periph(FLASH_ACTLR) & 3;
+}
+
+uint32_t rv_read(uint32_t address, int size)
+{
+    uint8_t * memory = rv_memory(address, size);
+    uint32_t value = 0;
+
+    if(memory) {
+        memcpy(&value, memory, size);
+        return value;
+    }
+    if(address - RV_PERIPH_BASE < RV_PERIPH_SIZE) return periph_read(address, size);
+    if(address - RV_PFIC_BASE < 2 * RV_CORE_SIZE) {
+        value = core_read(address & ~3u) >> ((address & 3) * 8);
+        return size == 4 ? value : value & ((1u << (size * 8)) - 1);
+    }
+    rv_fatal("bus error, %d byte read from %08X", size, address);
+}
+
+void rv_write(uint32_t address, uint32_t value, int size)
+{
+    if(rv_is_flash(address)) {
+        // Fast page programming, FLASH_BufLoad() stores the word to its address
+        if(!(*periph(FLASH_CTLR) & FLASH_PAGE_PG) || size != 4)
+            rv_fatal("write to flash %08X", address);
+        flash_buffer[(address / 4) % (FLASH_PAGE / 4)] = value;
+        return;
+    }
+    if(address - RV_RAM_BASE < RV_RAM_SIZE) {
+        memcpy(&rv_ram[address - RV_RAM_BASE], &value, size);
+        return;
+    }
+    if(address - RV_PERIPH_BASE < RV_PERIPH_SIZE) {
+        periph_write(address, value, size);
+        return;
+    }
+    if(address - RV_PFIC_BASE < 2 * RV_CORE_SIZE && size == 4) {
+        core_write(address, value);
+        return;
+    }
+    if(address - RV_PFIC_BASE < 2 * RV_CORE_SIZE) {
+        uint32_t reg = address & ~3u, shift = (address & 3) * 8, mask = ((1u << (size * 8)) - 1) << shift;
+        core_write(reg, (core_read(reg) & ~mask) | ((value << shift) & mask));
+        return;
+    }
+    rv_fatal("bus error, %d byte write to %08X", size, address);
+}
+
+uint32_t rv_fetch16(uint32_t address)
+{
+    uint16_t value;
+
+    if(address < RV_FLASH_SIZE - 1) memcpy(&value, &rv_flash[address], 2);
+    else if(address - RV_RAM_BASE < RV_RAM_SIZE - 1) memcpy(&value, &rv_ram[address - RV_RAM_BASE], 2);
+    else rv_fatal("instruction fetch from %08X", address);
+    return value;
+}
+
+/*********************************************************************
+ * @fn      rv_irq_pending
+ *
+ * @brief   Update the PFIC pending bits from the peripherals.
+ *
+ * @return  lowest numbered interrupt both pending and enabled, or -1
+ */
+int rv_irq_pending(void)
+{
+    uint32_t pending[2] = {pfic_pending[0], pfic_pending[1]};
+
+    stk_update();
+    if((*core(STK_SR) & 1) && (*core(STK_CTLR) & STK_STIE)) pending[0] |= 1u << RV_IRQ_SYSTICK;
+    if(usart_status() & *periph(USART_CTLR1) & (USART_RXNE | USART_TC | USART_TXE))
+        pending[RV_IRQ_USART1 / 32] |= 1u << (RV_IRQ_USART1 % 32);
+
+    for(int i = 0; i < 2; i++) {
+        pfic_ipr[i] = pending[i];
+        uint32_t active = pending[i] & pfic_enabled[i];
+        if(active) return i * 32 + __builtin_ctz(active);
+    }
+    return -1;
+}
+
+int rv_wake_pending(void)
+{
+    return rv_irq_pending() >= 0;
+}
+
+uint64_t rv_next_event(void)
+{
+    if(!(*core(STK_CTLR) & STK_STE) || !(*core(STK_CTLR) & STK_STIE)) return UINT64_MAX;
+    return stk_event > rv.cycles ? stk_event : rv.cycles;
+}
+
+void rv_advance(uint64_t cycles)
+{
+    if(cycles > rv.cycles) rv.cycles = cycles;
+}
+
+uint64_t rv_cycles_ms(uint32_t ms)
+{
+    return (uint64_t)ms * (rcc_hclk() / 1000);
+}
+
+/*********************************************************************
+ * @fn      rv_load_elf
+ *
+ * @brief   Load the loadable segments of a firmware ELF into flash by
+ *          load (physical) address, initialize the system area and
+ *          take a power on reset.
+ *
+ * @param   path - firmware .elf, as built by the MounRiver project
+ *
+ * @return  none
+ */
+void rv_load_elf(const char * path)
+{
+    FILE * f = fopen(path, "rb");
+    uint8_t ehdr[52];
+
+    if(!f) {
+        perror(path);
+        exit(1);
+    }
+    if(fread(ehdr, 1, sizeof(ehdr), f) != sizeof(ehdr) || memcmp(ehdr, "\177ELF\001\001", 6) ||
+       (ehdr[18] | (ehdr[19] << 8)) != 243) {   // ELFCLASS32, little endian, EM_RISCV
+        fprintf(stderr, "%s: not a 32-bit RISC-V ELF\n", path);
+        exit(1);
+    }
+    memset(rv_flash, 0xFF, sizeof(rv_flash));
+    rv_entry = REG32(ehdr, 24);
+    uint32_t phoff = REG32(ehdr, 28);
+    uint32_t phentsize = ehdr[42] | (ehdr[43] << 8), phnum = ehdr[44] | (ehdr[45] << 8);
+
+    for(uint32_t i = 0; i < phnum; i++) {
+        uint8_t phdr[32];
+        if(fseek(f, phoff + i * phentsize, SEEK_SET) || fread(phdr, 1, sizeof(phdr), f) != sizeof(phdr))
+            break;
+        uint32_t offset = REG32(phdr, 4), paddr = REG32(phdr, 12), filesz = REG32(phdr, 16);
+        if(REG32(phdr, 0) != 1 || !filesz) continue;    // PT_LOAD with contents
+        if(paddr - RV_FLASH_ALIAS < RV_FLASH_SIZE) paddr -= RV_FLASH_ALIAS;
+        if(paddr >= RV_FLASH_SIZE || filesz > RV_FLASH_SIZE - paddr) {
+            fprintf(stderr, "%s: segment at %08X does not fit in flash\n", path, paddr);
+            exit(1);
+        }
+        if(fseek(f, offset, SEEK_SET) || fread(&rv_flash[paddr], 1, filesz, f) != filesz) {
+            fprintf(stderr, "%s: truncated\n", path);
+            exit(1);
+        }
+    }
+    fclose(f);
+
+    memset(&rv_sys[0x800], 0xFF, 0x10);                    // option bytes, erased
+    *(uint16_t *)&rv_sys[0x7E0] = RV_FLASH_SIZE / 1024;    // electronic signature
+    for(int i = 0; i < 12; i++) rv_sys[0x7E8 + i] = (uint8_t)(0x51 + i * 0x11);
+    *periph(RCC_CTLR) = 0x83;
+    *periph(RCC_RSTSCKR) = RCC_POR_FLAGS;
+    *periph(FLASH_CTLR) = FLASH_LOCK | FLASH_FLOCK;
+    rv_reset(rv_entry);
+}
+
+// Event log and key/value store pages, 0x3C00..0x3FFF, kept across runs
+void rv_flash_image(const char * path, int save)
+{
+    FILE * f = fopen(path, save ? "wb" : "rb");
+
+    if(!f) {
+        if(save) perror(path);
+        return;
+    }
+    if(save) fwrite(&rv_flash[0x3C00], 1, 0x400, f);
+    else if(fread(&rv_flash[0x3C00], 1, 0x400, f) != 0x400) fprintf(stderr, "%s: short image\n", path);
+    fclose(f);
+}
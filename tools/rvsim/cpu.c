@@ -0,0 +1,466 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : cpu.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : RV32EC + Zicsr interpreter, traps and cycle model
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  Executes RV32E base integer instructions, the C (compressed) extension and
+  Zicsr.  There is no M extension on the CH32V003, multiply and divide come
+  from libgcc.  The WCH "XW" compressed byte/halfword loads and stores are
+  not decoded, link the firmware for simulation with XW turned off
+  (MounRiver: Target Processor, Extra Compressed extension (RVXW) unchecked,
+  or -march=rv32ec_zicsr).  An XW or other illegal instruction stops the
+  run with the address, rather than taking the HardFault loop.
+
+  Interrupts follow the PFIC in vector table mode (mtvec bits 1:0 = 3, the
+  table holds handler addresses, see Startup/startup_ch32v00x.S).  With HPE
+  enabled (INTSYSCR, CSR 0x804, bit 0) the caller saved registers are saved
+  and restored around the handler in a two level shadow, like the hardware,
+  so "WCH-Interrupt-fast" handlers without their own prologue run correctly.
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "rvsim.h"
+
+#define MSTATUS_MIE   (1 << 3)
+#define MSTATUS_MPIE  (1 << 7)
+#define MSTATUS_MPP   (3 << 11)
+#define INTSYSCR_HPE  (1 << 0)
+#define RV_MISA       0x40800014  // RV32, C, E, X
+
+#define NO_WORD       0xFFFFFFFF  // fetch_word after a jump, next fetch pays wait states
+
+RV_CPU rv;
+
+static uint32_t rv_inst_pc;        // address of the instruction executing
+static uint32_t rv_next_pc;
+static uint32_t rv_inst_cycles;
+
+void rv_fatal(const char * format, ...)
+{
+    va_list args;
+
+    fflush(stdout);
+    fprintf(stderr, "\nrvsim: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, ", pc %08X, ra %08X, sp %08X, %llu cycles\n", rv_inst_pc, rv.x[1], rv.x[2],
+            (unsigned long long)rv.cycles);
+    exit(1);
+}
+
+void rv_reset(uint32_t entry)
+{
+    uint64_t cycles = rv.cycles, busy = rv.busy, instret = rv.instret;
+
+    rv = (RV_CPU){0};
+    rv.cycles = cycles;     // time keeps running across a system reset
+    rv.busy = busy;
+    rv.instret = instret;
+    rv.pc = entry;
+    rv.mstatus = MSTATUS_MPP;
+    rv.fetch_word = NO_WORD;
+}
+
+static int32_t sext(uint32_t value, int bits)
+{
+    return (int32_t)(value << (32 - bits)) >> (32 - bits);
+}
+
+static void rv_illegal(uint32_t inst)
+{
+    uint32_t op = inst & 3, funct3 = (inst >> 13) & 7;
+
+    if(op != 3 && ((op == 0 && (funct3 == 1 || funct3 == 4 || funct3 == 5)) ||
+                   (op == 2 && (funct3 == 1 || funct3 == 5))))
+        rv_fatal("XW instruction %04X, build without the RVXW extension", inst);
+    rv_fatal("illegal instruction %0*X", op == 3 ? 8 : 4, inst);
+}
+
+static uint32_t rv_reg(uint32_t index, uint32_t inst)
+{
+    if(index > 15) rv_illegal(inst);  // RV32E has 16 registers
+    return rv.x[index];
+}
+
+static void rv_set(uint32_t index, uint32_t value, uint32_t inst)
+{
+    if(index > 15) rv_illegal(inst);
+    if(index) rv.x[index] = value;
+}
+
+static void rv_jump(uint32_t target)
+{
+    if(target & 1) rv_fatal("jump to odd address %08X", target);
+    rv_next_pc = target;
+    rv_inst_cycles += RV_CYCLES_TAKEN;
+    rv.fetch_word = NO_WORD;
+}
+
+static uint32_t rv_load(uint32_t address, int size, int is_signed)
+{
+    if(address & (size - 1)) rv_fatal("misaligned %d byte load from %08X", size, address);
+    rv_inst_cycles += RV_CYCLES_LOAD;
+    if(rv_is_flash(address)) rv_inst_cycles += rv_flash_wait_states();
+    uint32_t value = rv_read(address, size);
+    if(is_signed && size < 4) value = (uint32_t)sext(value, size * 8);
+    return value;
+}
+
+static void rv_store(uint32_t address, uint32_t value, int size)
+{
+    if(address & (size - 1)) rv_fatal("misaligned %d byte store to %08X", size, address);
+    rv_write(address, value, size);
+}
+
+// Synchronous exception or interrupt, vector table mode
+static void rv_trap(uint32_t cause, uint32_t vector, uint32_t epc)
+{
+    rv.mepc = epc;
+    rv.mcause = cause;
+    rv.mstatus = (rv.mstatus & ~(MSTATUS_MIE | MSTATUS_MPIE)) |
+                 ((rv.mstatus & MSTATUS_MIE) ? MSTATUS_MPIE : 0) | MSTATUS_MPP;
+    if((rv.intsyscr & INTSYSCR_HPE) && rv.hpe_depth < 2) {
+        for(int i = 0; i < 16; i++) rv.hpe_save[rv.hpe_depth][i] = rv.x[i];
+    }
+    rv.hpe_depth++;
+
+    uint32_t base = rv.mtvec & ~3u;
+    if((rv.mtvec & 3) == 3)
+        rv.pc = rv_read(base + vector * 4, 4);
+    else if(rv.mtvec & 1)
+        rv.pc = base + vector * 4;
+    else
+        rv.pc = base;
+    rv.fetch_word = NO_WORD;
+    rv.cycles += RV_CYCLES_TRAP;
+    rv.busy += RV_CYCLES_TRAP;
+}
+
+static void rv_mret(void)
+{
+    if(rv.hpe_depth > 0) {
+        rv.hpe_depth--;
+        if((rv.intsyscr & INTSYSCR_HPE) && rv.hpe_depth < 2) {
+            // caller saved registers: ra, t0-t2, a0-a5
+            static const uint8_t saved[] = {1, 5, 6, 7, 10, 11, 12, 13, 14, 15};
+            for(unsigned i = 0; i < sizeof(saved); i++)
+                rv.x[saved[i]] = rv.hpe_save[rv.hpe_depth][saved[i]];
+        }
+    }
+    rv.mstatus = (rv.mstatus & ~MSTATUS_MIE) | ((rv.mstatus & MSTATUS_MPIE) ? MSTATUS_MIE : 0) | MSTATUS_MPIE;
+    rv_jump(rv.mepc);
+    rv_inst_cycles += RV_CYCLES_TRAP;
+}
+
+static uint32_t * rv_csr(uint32_t csr)
+{
+    static uint32_t scratch;
+
+    switch(csr) {
+    case 0x300: return &rv.mstatus;
+    case 0x305: return &rv.mtvec;
+    case 0x340: return &rv.mscratch;
+    case 0x341: return &rv.mepc;
+    case 0x342: return &rv.mcause;
+    case 0x343: return &rv.mtval;
+    case 0x804: return &rv.intsyscr;
+    case 0x301: scratch = RV_MISA; return &scratch;
+    default:    scratch = 0; return &scratch;   // unimplemented, reads zero, writes ignored
+    }
+}
+
+static void rv_system(uint32_t inst)
+{
+    uint32_t funct3 = (inst >> 12) & 7, rd = (inst >> 7) & 31, rs1 = (inst >> 15) & 31;
+    uint32_t csr = inst >> 20;
+
+    if(funct3 == 0) {
+        switch(inst) {
+        case 0x00000073: rv_trap(11, RV_EXC_HARDFAULT, rv_inst_pc); rv_next_pc = rv.pc; return; // ecall
+        case 0x00100073: rv_fatal("ebreak");
+        case 0x30200073: rv_mret(); return;
+        case 0x10500073: // wfi
+            if(!rv_wake_pending()) rv.wfi = 1;
+            return;
+        default: rv_illegal(inst);
+        }
+    }
+
+    uint32_t * reg = rv_csr(csr);
+    uint32_t old = *reg;
+    uint32_t src = (funct3 & 4) ? rs1 : rv_reg(rs1, inst);
+    switch(funct3 & 3) {
+    case 1: *reg = src; break;                      // csrrw
+    case 2: if(rs1) *reg = old | src; break;        // csrrs
+    case 3: if(rs1) *reg = old & ~src; break;       // csrrc
+    default: rv_illegal(inst);
+    }
+    rv_set(rd, old, inst);
+}
+
+static void rv_execute32(uint32_t inst)
+{
+    uint32_t opcode = inst & 0x7F, rd = (inst >> 7) & 31, funct3 = (inst >> 12) & 7;
+    uint32_t rs1 = (inst >> 15) & 31, rs2 = (inst >> 20) & 31, funct7 = inst >> 25;
+    int32_t imm_i = (int32_t)inst >> 20;
+    int32_t imm_s = ((int32_t)inst >> 25 << 5) | ((inst >> 7) & 31);
+    int32_t imm_b = sext(((inst >> 19) & 0x1000) | ((inst << 4) & 0x800) | ((inst >> 20) & 0x7E0) |
+                         ((inst >> 7) & 0x1E), 13);
+    int32_t imm_j = sext(((inst >> 11) & 0x100000) | (inst & 0xFF000) | ((inst >> 9) & 0x800) |
+                         ((inst >> 20) & 0x7FE), 21);
+    uint32_t a, b;
+
+    switch(opcode) {
+    case 0x37: rv_set(rd, inst & 0xFFFFF000, inst); break;                 // lui
+    case 0x17: rv_set(rd, rv_inst_pc + (inst & 0xFFFFF000), inst); break;  // auipc
+    case 0x6F: rv_set(rd, rv_next_pc, inst); rv_jump(rv_inst_pc + imm_j); break;
+    case 0x67:
+        a = rv_reg(rs1, inst);
+        rv_set(rd, rv_next_pc, inst);
+        rv_jump((a + imm_i) & ~1u);
+        break;
+    case 0x63: {
+        int taken;
+        a = rv_reg(rs1, inst);
+        b = rv_reg(rs2, inst);
+        switch(funct3) {
+        case 0: taken = (a == b); break;
+        case 1: taken = (a != b); break;
+        case 4: taken = ((int32_t)a < (int32_t)b); break;
+        case 5: taken = ((int32_t)a >= (int32_t)b); break;
+        case 6: taken = (a < b); break;
+        case 7: taken = (a >= b); break;
+        default: rv_illegal(inst); return;
+        }
+        if(taken) rv_jump(rv_inst_pc + imm_b);
+        break;
+    }
+    case 0x03:
+        a = rv_reg(rs1, inst) + imm_i;
+        switch(funct3) {
+        case 0: rv_set(rd, rv_load(a, 1, 1), inst); break;
+        case 1: rv_set(rd, rv_load(a, 2, 1), inst); break;
+        case 2: rv_set(rd, rv_load(a, 4, 0), inst); break;
+        case 4: rv_set(rd, rv_load(a, 1, 0), inst); break;
+        case 5: rv_set(rd, rv_load(a, 2, 0), inst); break;
+        default: rv_illegal(inst);
+        }
+        break;
+    case 0x23:
+        a = rv_reg(rs1, inst) + imm_s;
+        b = rv_reg(rs2, inst);
+        switch(funct3) {
+        case 0: rv_store(a, b, 1); break;
+        case 1: rv_store(a, b, 2); break;
+        case 2: rv_store(a, b, 4); break;
+        default: rv_illegal(inst);
+        }
+        break;
+    case 0x13:
+        a = rv_reg(rs1, inst);
+        switch(funct3) {
+        case 0: b = a + imm_i; break;
+        case 1: if(funct7) rv_illegal(inst); b = a << rs2; break;
+        case 2: b = ((int32_t)a < imm_i); break;
+        case 3: b = (a < (uint32_t)imm_i); break;
+        case 4: b = a ^ imm_i; break;
+        case 5:
+            if(funct7 == 0x20) b = (uint32_t)((int32_t)a >> rs2);
+            else if(funct7 == 0) b = a >> rs2;
+            else { rv_illegal(inst); return; }
+            break;
+        case 6: b = a | imm_i; break;
+        default: b = a & imm_i; break;
+        }
+        rv_set(rd, b, inst);
+        break;
+    case 0x33:
+        a = rv_reg(rs1, inst);
+        b = rv_reg(rs2, inst);
+        if(funct7 != 0 && !(funct7 == 0x20 && (funct3 == 0 || funct3 == 5))) rv_illegal(inst);
+        switch(funct3) {
+        case 0: a = funct7 ? a - b : a + b; break;
+        case 1: a = a << (b & 31); break;
+        case 2: a = ((int32_t)a < (int32_t)b); break;
+        case 3: a = (a < b); break;
+        case 4: a = a ^ b; break;
+        case 5: a = funct7 ? (uint32_t)((int32_t)a >> (b & 31)) : a >> (b & 31); break;
+        case 6: a = a | b; break;
+        default: a = a & b; break;
+        }
+        rv_set(rd, a, inst);
+        break;
+    case 0x0F: break;  // fence
+    case 0x73: rv_system(inst); break;
+    default: rv_illegal(inst);
+    }
+}
+
+static void rv_execute16(uint32_t inst)
+{
+    uint32_t funct3 = (inst >> 13) & 7;
+    uint32_t rd = (inst >> 7) & 31, rs2 = (inst >> 2) & 31;
+    uint32_t rdp = ((inst >> 7) & 7) + 8, rs2p = ((inst >> 2) & 7) + 8;  // x8..x15
+    int32_t imm6 = sext(((inst >> 7) & 0x20) | ((inst >> 2) & 0x1F), 6);
+    uint32_t a;
+
+    switch(((inst & 3) << 3) | funct3) {
+    case 000: { // c.addi4spn
+        uint32_t imm = ((inst >> 7) & 0x30) | ((inst >> 1) & 0x3C0) | ((inst >> 4) & 4) | ((inst >> 2) & 8);
+        if(!imm) rv_illegal(inst);
+        rv_set(rs2p, rv.x[2] + imm, inst);
+        break;
+    }
+    case 002: // c.lw
+    case 006: { // c.sw
+        uint32_t imm = ((inst >> 7) & 0x38) | ((inst >> 4) & 4) | ((inst << 1) & 0x40);
+        a = rv.x[rdp] + imm;
+        if(funct3 == 2) rv_set(rs2p, rv_load(a, 4, 0), inst);
+        else rv_store(a, rv.x[rs2p], 4);
+        break;
+    }
+    case 010: rv_set(rd, rv_reg(rd, inst) + imm6, inst); break;  // c.addi, c.nop
+    case 011: // c.jal
+    case 015: { // c.j
+        int32_t imm = sext(((inst >> 1) & 0x800) | ((inst >> 7) & 0x10) | ((inst >> 1) & 0x300) |
+                           ((inst << 2) & 0x400) | ((inst >> 1) & 0x40) | ((inst << 1) & 0x80) |
+                           ((inst >> 2) & 0xE) | ((inst << 3) & 0x20), 12);
+        if(funct3 == 1) rv.x[1] = rv_next_pc;
+        rv_jump(rv_inst_pc + imm);
+        break;
+    }
+    case 012: rv_set(rd, imm6, inst); break;  // c.li
+    case 013:
+        if(rd == 2) { // c.addi16sp
+            int32_t imm = sext(((inst >> 3) & 0x200) | ((inst >> 2) & 0x10) | ((inst << 1) & 0x40) |
+                               ((inst << 4) & 0x180) | ((inst << 3) & 0x20), 10);
+            if(!imm) rv_illegal(inst);
+            rv.x[2] += imm;
+        }
+        else { // c.lui
+            if(!imm6) rv_illegal(inst);
+            rv_set(rd, (uint32_t)imm6 << 12, inst);
+        }
+        break;
+    case 014: {
+        uint32_t shamt = ((inst >> 7) & 0x20) | ((inst >> 2) & 0x1F);
+        a = rv.x[rdp];
+        switch((inst >> 10) & 3) {
+        case 0: if(shamt & 0x20) rv_illegal(inst); a >>= shamt; break;                       // c.srli
+        case 1: if(shamt & 0x20) rv_illegal(inst); a = (uint32_t)((int32_t)a >> shamt); break; // c.srai
+        case 2: a &= imm6; break;                                                          // c.andi
+        default:
+            if(inst & 0x1000) rv_illegal(inst);
+            switch((inst >> 5) & 3) {
+            case 0: a -= rv.x[rs2p]; break;
+            case 1: a ^= rv.x[rs2p]; break;
+            case 2: a |= rv.x[rs2p]; break;
+            default: a &= rv.x[rs2p]; break;
+            }
+        }
+        rv.x[rdp] = a;
+        break;
+    }
+    case 016: // c.beqz
+    case 017: { // c.bnez
+        int32_t imm = sext(((inst >> 4) & 0x100) | ((inst << 1) & 0xC0) | ((inst << 3) & 0x20) |
+                           ((inst >> 7) & 0x18) | ((inst >> 2) & 6), 9);
+        if((rv.x[rdp] == 0) == (funct3 == 6)) rv_jump(rv_inst_pc + imm);
+        break;
+    }
+    case 020: // c.slli
+        if(inst & 0x1000) rv_illegal(inst);
+        rv_set(rd, rv_reg(rd, inst) << rs2, inst);
+        break;
+    case 022: { // c.lwsp
+        uint32_t imm = ((inst >> 7) & 0x20) | ((inst >> 2) & 0x1C) | ((inst << 4) & 0xC0);
+        if(!rd) rv_illegal(inst);
+        rv_set(rd, rv_load(rv.x[2] + imm, 4, 0), inst);
+        break;
+    }
+    case 024:
+        if(!(inst & 0x1000)) {
+            if(rs2) rv_set(rd, rv_reg(rs2, inst), inst);          // c.mv
+            else if(rd) rv_jump(rv_reg(rd, inst) & ~1u);         // c.jr
+            else rv_illegal(inst);
+        }
+        else {
+            if(rs2) rv_set(rd, rv_reg(rd, inst) + rv_reg(rs2, inst), inst);  // c.add
+            else if(rd) {                                                  // c.jalr
+                a = rv_reg(rd, inst);
+                rv.x[1] = rv_next_pc;
+                rv_jump(a & ~1u);
+            }
+            else rv_fatal("c.ebreak");
+        }
+        break;
+    case 026: { // c.swsp
+        uint32_t imm = ((inst >> 7) & 0x3C) | ((inst >> 1) & 0xC0);
+        rv_store(rv.x[2] + imm, rv_reg(rs2, inst), 4);
+        break;
+    }
+    default:
+        rv_illegal(inst);
+    }
+}
+
+// Wait states for an instruction fetch, once per new 32-bit flash word
+static void rv_fetch_cost(uint32_t address)
+{
+    if(!rv_is_flash(address)) return;
+    if((address >> 2) != rv.fetch_word) {
+        rv.fetch_word = address >> 2;
+        rv_inst_cycles += rv_flash_wait_states();
+    }
+}
+
+/*********************************************************************
+ * @fn      rv_step
+ *
+ * @brief   Take a pending interrupt, or execute one instruction and
+ *          account its cycles.
+ *
+ * @return  none
+ */
+void rv_step(void)
+{
+    if(rv.mstatus & MSTATUS_MIE) {
+        int irq = rv_irq_pending();
+        if(irq >= 0) {
+            rv_trap(0x80000000u | irq, irq, rv.pc);
+            return;
+        }
+    }
+
+    rv_inst_pc = rv.pc;
+    rv_inst_cycles = 1;
+    if(rv_inst_pc & 1) rv_fatal("odd pc");
+    rv_fetch_cost(rv_inst_pc);
+    uint32_t inst = rv_fetch16(rv_inst_pc);
+    if((inst & 3) == 3) {
+        rv_fetch_cost(rv_inst_pc + 2);
+        inst |= rv_fetch16(rv_inst_pc + 2) << 16;
+        rv_next_pc = rv_inst_pc + 4;
+        rv_execute32(inst);
+    }
+    else {
+        rv_next_pc = rv_inst_pc + 2;
+        rv_execute16(inst);
+    }
+
+    if(rv.pc == rv_inst_pc) rv.pc = rv_next_pc;  // not redirected by a trap
+    rv.x[0] = 0;
+    rv.cycles += rv_inst_cycles;
+    rv.busy += rv_inst_cycles;
+    rv.instret++;
+}
@@ -0,0 +1,277 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : main.c
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : RV32EC simulator, console script and cycle report
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+/*
+ *@Note
+  rvsim [-f flash.bin] [-r report] [-b baseline [-p percent]] [-l cycles] firmware.elf < script
+
+  Runs the firmware image instruction by instruction.  Console input comes
+  from the script one line at a time: the next line is sent once the
+  firmware has read the previous one and is waiting in WFI, so each line's
+  cycles cover exactly the work it caused.  Time only passes while the
+  core runs, idle periods are skipped, the run is deterministic.
+
+  Script lines starting with '!' go to the simulator instead of the
+  firmware: "!vdd <mV>", "!adc <channel> <mV>", "!sleep <ms>" (idle with
+  SysTick running), "!quit", and the DS3231 model commands.  Lines
+  starting with '#' are ignored.
+
+  At the end of the script the busy cycles and instructions of boot and
+  every line are written to stderr, or to the -r file.  With -b, each line
+  is compared with a previous report; -p sets the growth in percent that
+  fails the run (exit status 3).  A line that runs longer than -l cycles
+  (default 1e9) ends the run with exit status 2.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rvsim.h"
+#include "../host/sim.h"
+
+#define RV_LINE_MAX     128
+#define RV_RECORD_NAME  48
+
+typedef struct {
+    char     command[RV_RECORD_NAME];
+    uint64_t cycles;
+    uint64_t instret;
+} RV_RECORD;
+
+static RV_RECORD * records;
+static int         record_count, record_size;
+static uint64_t    record_busy, record_instret;  // at the start of the current record
+static RV_RECORD * baseline;
+static int         baseline_count;
+
+static uint8_t  rx_queue[RV_LINE_MAX + 2];
+static int      rx_head, rx_count;
+static uint64_t idle_until;
+static int      script_done;
+
+int rv_console_rx(uint8_t * data)
+{
+    if(!rx_count) return 0;
+    *data = rx_queue[rx_head++];
+    rx_count--;
+    return 1;
+}
+
+int rv_console_pending(void)
+{
+    return rx_count;
+}
+
+void rv_console_tx(uint8_t data)
+{
+    putchar(data);
+}
+
+// Close the current record, start a new one for command
+static void rv_record(const char * command)
+{
+    if(record_count) {
+        records[record_count - 1].cycles = rv.busy - record_busy;
+        records[record_count - 1].instret = rv.instret - record_instret;
+    }
+    if(!command) return;
+    if(record_count == record_size) {
+        record_size = record_size ? record_size * 2 : 64;
+        records = realloc(records, record_size * sizeof(RV_RECORD));
+        if(!records) {
+            perror("rvsim");
+            exit(1);
+        }
+    }
+    snprintf(records[record_count].command, RV_RECORD_NAME, "%s", command);
+    record_count++;
+    record_busy = rv.busy;
+    record_instret = rv.instret;
+}
+
+static void rv_command(char * line)
+{
+    char * argv[8];
+    int argc = 0;
+
+    for(char * tok = strtok(line, " \t\r\n"); tok && argc < 8; tok = strtok(NULL, " \t\r\n"))
+        argv[argc++] = tok;
+    if(!argc) return;
+
+    if(!strcmp(argv[0], "vdd") && argc == 2)
+        sim_vdd_mv = strtoul(argv[1], NULL, 0);
+    else if(!strcmp(argv[0], "adc") && argc == 3 && strtoul(argv[1], NULL, 0) < SIM_ADC_CHANNELS)
+        sim_adc_mv[strtoul(argv[1], NULL, 0)] = (uint16_t)strtoul(argv[2], NULL, 0);
+    else if(!strcmp(argv[0], "sleep") && argc == 2)
+        idle_until = rv.cycles + rv_cycles_ms(strtoul(argv[1], NULL, 0));
+    else if(!strcmp(argv[0], "quit"))
+        script_done = 1;
+    else if(!sim_ds3231_command(argc, argv))
+        fprintf(stderr, "rvsim: unknown command: !%s\n", argv[0]);
+}
+
+// Firmware is idle with nothing queued, send the next script line.
+// Returns 0 at the end of the script.
+static int rv_console_feed(void)
+{
+    char line[RV_LINE_MAX + 2];
+
+    fflush(stdout);
+    while(!script_done && fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if(line[0] == '#') continue;
+        if(line[0] == '!') {
+            rv_command(line + 1);
+            if(idle_until > rv.cycles) return 1;
+            continue;
+        }
+        rv_record(line[0] ? line : "<enter>");
+        size_t length = strlen(line);
+        memcpy(rx_queue, line, length);
+        rx_queue[length] = '\r';
+        rx_head = 0;
+        rx_count = (int)length + 1;
+        return 1;
+    }
+    return 0;
+}
+
+static void rv_load_baseline(const char * path)
+{
+    FILE * f = fopen(path, "r");
+    char line[160];
+
+    if(!f) {
+        perror(path);
+        exit(1);
+    }
+    while(fgets(line, sizeof(line), f)) {
+        unsigned long long cycles, instret;
+        int used;
+        if(line[0] == '#' || sscanf(line, "%llu %llu %n", &cycles, &instret, &used) != 2) continue;
+        baseline = realloc(baseline, (baseline_count + 1) * sizeof(RV_RECORD));
+        if(!baseline) {
+            perror("rvsim");
+            exit(1);
+        }
+        line[strcspn(line, "\r\n")] = 0;
+        snprintf(baseline[baseline_count].command, RV_RECORD_NAME, "%s", line + used);
+        baseline[baseline_count].cycles = cycles;
+        baseline[baseline_count].instret = instret;
+        baseline_count++;
+    }
+    fclose(f);
+}
+
+// Same line of the same script, or else the first line with the same text
+static const RV_RECORD * rv_baseline_match(int index)
+{
+    if(index < baseline_count && !strcmp(baseline[index].command, records[index].command))
+        return &baseline[index];
+    for(int i = 0; i < baseline_count; i++)
+        if(!strcmp(baseline[i].command, records[index].command)) return &baseline[i];
+    return NULL;
+}
+
+// Write the report, return 1 if a line grew by more than percent
+static int rv_report(FILE * f, double percent)
+{
+    uint64_t total_cycles = 0, total_instret = 0;
+    int regressed = 0;
+
+    fprintf(f, "#     cycles  instructions%s  command\n", baseline ? "    change" : "");
+    for(int i = 0; i < record_count; i++) {
+        const RV_RECORD * record = &records[i];
+        fprintf(f, "%12llu  %12llu", (unsigned long long)record->cycles, (unsigned long long)record->instret);
+        if(baseline) {
+            const RV_RECORD * base = rv_baseline_match(i);
+            if(base && base->cycles) {
+                double change = 100.0 * ((double)record->cycles - (double)base->cycles) / (double)base->cycles;
+                fprintf(f, "  %+7.1f%%", change);
+                if(percent >= 0 && change > percent) regressed = 1;
+            }
+            else
+                fprintf(f, "       new");
+        }
+        fprintf(f, "  %s\n", record->command);
+        total_cycles += record->cycles;
+        total_instret += record->instret;
+    }
+    fprintf(f, "# %10llu  %12llu  total, %llu cycles including idle\n", (unsigned long long)total_cycles,
+            (unsigned long long)total_instret, (unsigned long long)rv.cycles);
+    return regressed;
+}
+
+static void rv_usage(void)
+{
+    fprintf(stderr, "usage: rvsim [-f flash.bin] [-r report] [-b baseline [-p percent]] [-l cycles] firmware.elf < script\n");
+    exit(1);
+}
+
+int main(int argc, char * argv[])
+{
+    const char * flash_file = NULL, * report_file = NULL;
+    uint64_t limit = 1000000000;
+    double percent = -1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "f:r:b:p:l:")) != -1) {
+        switch(opt) {
+        case 'f': flash_file = optarg; break;
+        case 'r': report_file = optarg; break;
+        case 'b': rv_load_baseline(optarg); break;
+        case 'p': percent = strtod(optarg, NULL); break;
+        case 'l': limit = strtoull(optarg, NULL, 0); break;
+        default:  rv_usage();
+        }
+    }
+    if(optind != argc - 1) rv_usage();
+
+    rv_load_elf(argv[optind]);
+    if(flash_file) rv_flash_image(flash_file, 0);
+    sim_ds3231_init();
+    rv_record("<boot>");
+
+    for(;;) {
+        if(!rv.wfi) {
+            rv_step();
+            if(rv.busy - record_busy > limit) {
+                rv_record(NULL);
+                fflush(stdout);
+                fprintf(stderr, "\nrvsim: \"%s\" ran more than %llu cycles\n", records[record_count - 1].command,
+                        (unsigned long long)limit);
+                rv_report(stderr, percent);
+                return 2;
+            }
+            continue;
+        }
+        if(rv_wake_pending()) rv.wfi = 0;
+        else if(rv.cycles < idle_until) {
+            uint64_t next = rv_next_event();
+            rv_advance(next < idle_until ? next : idle_until);
+        }
+        else if(rx_count) rv.wfi = 0;  // input without an RX interrupt enabled, wake anyway
+        else if(!rv_console_feed()) break;
+    }
+
+    rv_record(NULL);
+    fflush(stdout);
+    if(flash_file) rv_flash_image(flash_file, 1);
+
+    FILE * f = report_file ? fopen(report_file, "w") : stderr;
+    if(!f) {
+        perror(report_file);
+        return 1;
+    }
+    int regressed = rv_report(f, percent);
+    if(f != stderr) fclose(f);
+    return regressed ? 3 : 0;
+}
@@ -0,0 +1,83 @@
+/********************************** (C) COPYRIGHT *******************************
+ * File Name          : rvsim.h
+ * Author             : Jim Merkle
+ * Version            : V1.0.0
+ * Date               : 2026/10/18
+ * Description        : RV32EC instruction set simulator for the CH32V003
+ * Copyright (c) 2026 Jim Merkle
+ * SPDX-License-Identifier: Apache-2.0
+ *******************************************************************************/
+
+#ifndef TOOLS_RVSIM_RVSIM_H_
+#define TOOLS_RVSIM_RVSIM_H_
+
+#include <stdint.h>
+
+// Memory map, see Ld/Link.ld
+#define RV_FLASH_BASE     0x00000000
+#define RV_FLASH_ALIAS    0x08000000  // same flash, as seen by the flash controller
+#define RV_FLASH_SIZE     0x4000
+#define RV_RAM_BASE       0x20000000
+#define RV_RAM_SIZE       0x800
+#define RV_SYS_BASE       0x1FFFF000  // boot area, electronic signature, option bytes
+#define RV_SYS_SIZE       0x1000
+#define RV_PERIPH_BASE    0x40000000
+#define RV_PERIPH_SIZE    0x30000
+#define RV_PFIC_BASE      0xE000E000
+#define RV_SYSTICK_BASE   0xE000F000
+#define RV_CORE_SIZE      0x1000
+
+// Approximate QingKe V2A timing, in HCLK cycles.  Instructions take one
+// cycle, loads one more, taken branches and jumps refill the two stage
+// pipeline.  Each new 32-bit word fetched from flash costs the wait states
+// programmed in FLASH->ACTLR, as do data loads from flash.
+#define RV_CYCLES_LOAD        1   // extra, load
+#define RV_CYCLES_TAKEN       1   // extra, taken branch or jump
+#define RV_CYCLES_TRAP        8   // interrupt entry or mret, HPE save/restore
+#define RV_CYCLES_FLASH_PAGE  (48 * 2000) // fast page erase or program, ~2 ms at 48 MHz
+
+#define RV_IRQ_SYSTICK    12
+#define RV_IRQ_USART1     32
+#define RV_IRQS           48
+#define RV_EXC_HARDFAULT  3   // vector for all synchronous exceptions
+
+typedef struct {
+    uint32_t x[16];         // RV32E, x0..x15
+    uint32_t pc;
+    uint32_t mstatus, mtvec, mepc, mcause, mtval, mscratch, intsyscr;
+    uint64_t cycles;        // HCLK cycles since reset, includes idle
+    uint64_t busy;          // cycles spent executing, excludes WFI
+    uint64_t instret;       // instructions retired
+    uint32_t fetch_word;    // last flash word fetched, wait state model
+    int      wfi;           // 1: waiting for an interrupt
+    int      hpe_depth;     // hardware prologue/epilogue nesting
+    uint32_t hpe_save[2][16];
+} RV_CPU;
+
+extern RV_CPU rv;
+
+// cpu.c
+void rv_reset(uint32_t entry);
+void rv_step(void);
+void rv_fatal(const char * format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+// bus.c
+void     rv_load_elf(const char * path);
+uint32_t rv_read(uint32_t address, int size);
+void     rv_write(uint32_t address, uint32_t value, int size);
+uint32_t rv_fetch16(uint32_t address);
+int      rv_flash_wait_states(void);
+int      rv_is_flash(uint32_t address);
+int      rv_irq_pending(void);      // highest enabled pending IRQ, or -1
+int      rv_wake_pending(void);     // an enabled IRQ is pending, ignoring mstatus
+uint64_t rv_next_event(void);       // cycle of the next timed event, or UINT64_MAX
+void     rv_advance(uint64_t cycles); // idle until cycles
+uint64_t rv_cycles_ms(uint32_t ms);  // at the current HCLK
+void     rv_flash_image(const char * path, int save);
+
+// main.c, console
+int  rv_console_rx(uint8_t * data);  // 1 with a byte, 0 if none
+int  rv_console_pending(void);
+void rv_console_tx(uint8_t data);
+
+#endif /* TOOLS_RVSIM_RVSIM_H_ */
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 Jim Merkle
+# SPDX-License-Identifier: Apache-2.0
+#
+# File: uart_update.py
+#
+# Host side of the CH32V003 command line "update" command, see User/update.c
+#
+# Usage: uart_update.py <serial port> <firmware.bin> [baud]
+# Create firmware.bin with: riscv-none-embed-objcopy -O binary CH32V003_command_line.elf firmware.bin
+
+import struct
+import sys
+import time
+
+import serial  # pyserial
+
+UPD_SYNC = 0xA5
+UPD_SYNC_RSP = 0x5A
+UPD_DATA_SIZE = 64
+UPD_WINDOW = 3
+UPD_IMAGE_MAX = 0x3C00
+TIMEOUT = 0.5  # seconds without a response before resending
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(cmd, block, data=b""):
+    body = bytes([ord(cmd)]) + struct.pack("<H", block) + data.ljust(UPD_DATA_SIZE, b"\xff")
+    return bytes([UPD_SYNC]) + body + struct.pack("<H", crc16(body))
+
+
+def read_response(port):
+    # Hunt for response sync, return (status, block) or None on time-out
+    deadline = time.time() + TIMEOUT
+    while time.time() < deadline:
+        b = port.read(1)
+        if b and b[0] == UPD_SYNC_RSP:
+            rest = port.read(3)
+            if len(rest) == 3:
+                return chr(rest[0]), rest[1] | (rest[2] << 8)
+    return None
+
+
+def send_and_wait(port, cmd, block, data=b""):
+    for _ in range(5):
+        port.write(frame(cmd, block, data))
+        rsp = read_response(port)
+        if rsp and rsp[1] == block:
+            return rsp[0]
+    raise SystemExit("No response to '%s' frame" % cmd)
+
+
+def main():
+    if len(sys.argv) < 3:
+        raise SystemExit("Usage: uart_update.py <serial port> <firmware.bin> [baud]")
+    baud = int(sys.argv[3]) if len(sys.argv) > 3 else 115200
+    image = open(sys.argv[2], "rb").read()
+    if len(image) > UPD_IMAGE_MAX:
+        raise SystemExit("Image too large: %u bytes, maximum %u" % (len(image), UPD_IMAGE_MAX))
+    blocks = (len(image) + UPD_DATA_SIZE - 1) // UPD_DATA_SIZE
+
+    port = serial.Serial(sys.argv[1], baud, timeout=0.05)
+    port.write(b"\rupdate\r")
+    deadline = time.time() + 2
+    banner = b""
+    while b"Updater ready" not in banner:
+        if time.time() > deadline:
+            raise SystemExit("Device did not enter updater")
+        banner += port.read(64)
+    time.sleep(0.05)
+    port.reset_input_buffer()
+
+    start = time.time()
+    pending = {}  # block -> time sent
+    next_block = 0
+    done = set()
+    while len(done) < blocks:
+        # Keep the window full
+        while len(pending) < UPD_WINDOW and next_block < blocks:
+            if next_block not in done:
+                port.write(frame("W", next_block, image[next_block * UPD_DATA_SIZE:(next_block + 1) * UPD_DATA_SIZE]))
+                pending[next_block] = time.time()
+            next_block += 1
+        rsp = read_response(port)
+        if rsp is None:
+            # Go back to the oldest unacknowledged block
+            next_block = min(pending) if pending else next_block
+            pending.clear()
+            continue
+        status, block = rsp
+        pending.pop(block, None)
+        if status == "K":
+            done.add(block)
+        elif status == "A":
+            raise SystemExit("Block %u outside firmware area" % block)
+        sys.stdout.write("\r%u/%u blocks" % (len(done), blocks))
+        sys.stdout.flush()
+
+    elapsed = time.time() - start
+    print("\n%u bytes in %.2f s, %.0f bytes/s" % (len(image), elapsed, len(image) / elapsed))
+
+    status = send_and_wait(port, "V", 0, struct.pack("<IH", len(image), crc16(image)))
+    if status != "K":
+        raise SystemExit("Verify failed, device remains in updater, run again")
+    print("Verified, starting new firmware")
+    send_and_wait(port, "G", 0)
+
+
+if __name__ == "__main__":
+    main()